@@ -39,7 +39,7 @@ elif [ $check = undefined ]
 then
   check=no
 fi
-CFLAGS="-Wextra -Wall -std=c++20 -lgmpxx -I includes/pblib -I includes/kissat/src"
+CFLAGS="-Wextra -Wall -std=c++20 -pthread -lgmpxx -I includes/pblib -I includes/kissat/src"
 if [ $debug = yes ]
 then
   CFLAGS="$CFLAGS -g3 -Wall"
@@ -0,0 +1,32 @@
+#!/bin/sh
+# Compares the encodings of guessed relations (option '-pb') by the number
+# of clauses of the guesses, the kissat calls and the time used for proving
+# in guess-and-prove. Every design is verified once per encoding with a
+# single kissat thread, hence the proving times are comparable. Exhaustive
+# proving is disabled by '-ex 0', otherwise small sub-circuits are proven by
+# their truth tables and never reach kissat.
+#
+# usage: scripts/pb-encodings.sh [ <spec-mode> [ <aig> ... ] ]
+#
+# The spec mode defaults to '-mult-spec' and the designs to examples/*.aig.
+# The binary is taken from $TALISMAN, which defaults to ./talisman.
+
+TALISMAN=${TALISMAN:-./talisman}
+SPEC=${1:--mult-spec}
+[ $# -gt 0 ] && shift
+[ $# -eq 0 ] && set -- examples/*.aig
+[ -x "$TALISMAN" ] || { echo "*** pb-encodings.sh: '$TALISMAN' not found (run make)" 1>&2; exit 1; }
+
+printf "%-24s %-8s %14s %12s %14s\n" design encoding "guess clauses" "kissat calls" "proving [s]"
+for aig in "$@"
+do
+  for encoding in auto pblib adder bdd sorting card
+  do
+    "$TALISMAN" "$aig" "$SPEC" -gap -st 1 -ex 0 -pb $encoding | awk \
+      -v design="$(basename "$aig")" -v encoding=$encoding '
+      /of guesses\)/          { clauses = $(NF - 2) }
+      /kissat calls:/         { calls = $NF }
+      /used time for proving/ { for (i = 1; i <= NF; i++) if ($i == "seconds") time = $(i - 1) }
+      END { printf "%-24s %-8s %14s %12s %14s\n", design, encoding, clauses, calls, time }'
+  done
+done
@@ -0,0 +1,502 @@
+/*------------------------------------------------------------------------*/
+/*! \file circuit_cache.cpp
+    \brief contains the caches of linearized sub-circuits
+
+  The cache file starts with a magic string, followed by records of the form
+
+    hash (8 bytes) | key size (4 bytes) | value size (4 bytes) | key | value
+
+  where integers are stored in native byte order. A truncated last record,
+  e.g., of a run that was killed while saving, is ignored when loading and
+  cut off before the records of the next run are appended.
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#include "circuit_cache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+#include "hash_val.h"
+#include "signal_statistics.h"
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_cache_file = 51;  // cannot read or write the cache file
+/*------------------------------------------------------------------------*/
+// Local variables
+
+// / identifies cache files, the last character is the format version
+static const char magic[] = "TalisMan cache 2";
+static const size_t magic_size = sizeof magic - 1;
+static const size_t record_header_size = 16;
+
+// / name of the cache file, 0 if the cache is not used
+static const char* cache_name = 0;
+
+// / mapped cache file
+static const char* cache_data = 0;
+static size_t cache_size = 0;
+
+// / offset of the records in the mapped file by hash
+static std::unordered_multimap<uint64_t, size_t> cache_index;
+
+// / records that are appended at exit
+static std::string new_records;
+
+// / offset of the records in new_records by hash
+static std::unordered_multimap<uint64_t, size_t> new_index;
+
+// / approximate memory of an entry of CircuitCache besides its strings
+static const size_t entry_overhead = 128;
+
+CircuitCache cached_circuits;
+/*------------------------------------------------------------------------*/
+
+template<typename T>
+static void
+put(std::string& out, T val) {
+  out.append(reinterpret_cast<const char*>(&val), sizeof val);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+put_mpz(std::string& out, const mpz_class& c) {
+  size_t count = (mpz_sizeinbase(c.get_mpz_t(), 2) + 7) / 8;
+  std::string bytes(count, 0);
+  mpz_export(bytes.data(), &count, -1, 1, 0, 0, c.get_mpz_t());
+  put<uint8_t>(out, sgn(c) < 0);
+  put<uint32_t>(out, count);
+  out.append(bytes.data(), count);
+}
+
+/*------------------------------------------------------------------------*/
+// Reads from the mapped file, all reads fail once the end is exceeded
+class CacheReader {
+  const char* pos;
+  const char* end;
+
+  public:
+  CacheReader(const char* begin, size_t size)
+    : pos(begin)
+    , end(begin + size) {}
+
+  template<typename T>
+  bool get(T& val) {
+    if(static_cast<size_t>(end - pos) < sizeof val)
+      return 0;
+    memcpy(&val, pos, sizeof val);
+    pos += sizeof val;
+    return 1;
+  }
+
+  bool get_mpz(mpz_class& c) {
+    uint8_t neg;
+    uint32_t count;
+    if(!get(neg) || !get(count) || static_cast<size_t>(end - pos) < count)
+      return 0;
+    mpz_import(c.get_mpz_t(), count, -1, 1, 0, 0, pos);
+    if(neg)
+      c = -c;
+    pos += count;
+    return 1;
+  }
+
+  bool at_end() const { return pos == end; }
+};
+
+/*------------------------------------------------------------------------*/
+
+static void
+put_circuit(std::string& out, const std::vector<Normalized_poly>& circuit) {
+  put<uint32_t>(out, circuit.size());
+  for(const auto& p : circuit) {
+    put<uint32_t>(out, p.size());
+    for(size_t i = 0; i < p.size(); i++) {
+      put_mpz(out, p.coeffs[i]);
+      put<uint32_t>(out, p.terms[i].size());
+      for(const auto& v : p.terms[i])
+        put<uint64_t>(out, v);
+    }
+  }
+}
+
+/*------------------------------------------------------------------------*/
+// Serializes the compressed sub-circuit and the vanishing monomials among
+// its variables, which the normal forms may depend on
+static std::string
+cache_key(const LinearizationContext& ctx) {
+  std::string key;
+  put_circuit(key, ctx.circuit);
+
+  // var_to_id is ordered by address, hence the facts are sorted by id
+  std::vector<std::tuple<uint8_t, uint64_t, uint64_t>> facts;
+  for(const auto& [v, id] : ctx.var_to_id) {
+    if(v->is_dual())
+      continue;
+    Gate* g = gate(v->get_num());
+    for(const auto& twin : g->get_van_twins()) {
+      auto it = ctx.var_to_id.find(twin->get_var());
+      if(it != ctx.var_to_id.end())
+        facts.emplace_back(0, id, it->second);
+    }
+    for(const auto& twin : g->get_dual_twins()) {
+      auto it = ctx.var_to_id.find(twin->get_var());
+      if(it != ctx.var_to_id.end())
+        facts.emplace_back(1, id, it->second);
+      it = ctx.var_to_id.find(twin->get_var()->get_dual());
+      if(it != ctx.var_to_id.end())
+        facts.emplace_back(2, id, it->second);
+    }
+  }
+  std::sort(facts.begin(), facts.end());
+  put<uint32_t>(key, facts.size());
+  for(const auto& [kind, a, b] : facts) {
+    put<uint8_t>(key, kind);
+    put<uint64_t>(key, a);
+    put<uint64_t>(key, b);
+  }
+  return key;
+}
+
+/*------------------------------------------------------------------------*/
+
+static std::string
+cache_value(const std::vector<compressed_polynomial>& res) {
+  std::string value;
+  put<uint32_t>(value, res.size());
+  for(const auto& p : res) {
+    put<uint32_t>(value, p.size());
+    for(const auto& [c, id] : p) {
+      put_mpz(value, c);
+      put<uint64_t>(value, id);
+    }
+  }
+  return value;
+}
+
+/*------------------------------------------------------------------------*/
+
+static bool
+read_value(CacheReader& in, std::vector<compressed_polynomial>& res) {
+  uint32_t num_polys;
+  if(!in.get(num_polys))
+    return 0;
+  res.clear();
+  res.resize(num_polys);
+  for(auto& p : res) {
+    uint32_t len;
+    if(!in.get(len))
+      return 0;
+    for(uint32_t i = 0; i < len; i++) {
+      mpz_class c;
+      uint64_t id;
+      if(!in.get_mpz(c) || !in.get(id))
+        return 0;
+      p.emplace_back(c, id);
+    }
+  }
+  return in.at_end();
+}
+
+/*------------------------------------------------------------------------*/
+
+bool
+CircuitCache::find(const std::vector<Normalized_poly>& circuit,
+                   std::vector<compressed_polynomial>& res) {
+  uint64_t hash = circuit_hash()(circuit);
+  std::string key;
+  put_circuit(key, circuit);
+
+  Shard& shard = shards[hash % num_shards];
+  std::lock_guard<std::mutex> guard(shard.lock);
+  auto range = shard.index.equal_range(hash);
+  for(auto it = range.first; it != range.second; ++it) {
+    auto entry = it->second;
+    if(entry->key != key)
+      continue;
+    shard.entries.splice(shard.entries.begin(), shard.entries, entry);
+    CacheReader in(entry->value.data(), entry->value.size());
+    read_value(in, res);
+    shard.hits++;
+    return 1;
+  }
+  shard.misses++;
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+CircuitCache::insert(const std::vector<Normalized_poly>& circuit,
+                     const std::vector<compressed_polynomial>& res) {
+  uint64_t hash = circuit_hash()(circuit);
+  Entry e{ hash, std::string(), cache_value(res) };
+  put_circuit(e.key, circuit);
+  size_t entry_bytes = e.key.size() + e.value.size() + entry_overhead;
+
+  // cache hits are applied as proof patterns, which are only defined once
+  size_t budget = proof_logging ? 0 : (cache_memory << 20) / num_shards;
+
+  Shard& shard = shards[hash % num_shards];
+  std::lock_guard<std::mutex> guard(shard.lock);
+  auto range = shard.index.equal_range(hash);
+  for(auto it = range.first; it != range.second; ++it) {
+    if(it->second->key != e.key)
+      continue;
+    size_t old_bytes
+      = it->second->key.size() + it->second->value.size() + entry_overhead;
+    shard.bytes -= old_bytes;
+    bytes -= old_bytes;
+    shard.entries.erase(it->second);
+    shard.index.erase(it);
+    break;
+  }
+  shard.entries.push_front(std::move(e));
+  shard.index.emplace(hash, shard.entries.begin());
+  shard.bytes += entry_bytes;
+  size_t total = bytes += entry_bytes;
+
+  while(budget && shard.bytes > budget && shard.entries.size() > 1) {
+    Entry& last = shard.entries.back();
+    range = shard.index.equal_range(last.hash);
+    for(auto it = range.first; it != range.second; ++it) {
+      if(&*it->second == &last) {
+        shard.index.erase(it);
+        break;
+      }
+    }
+    size_t old_bytes = last.key.size() + last.value.size() + entry_overhead;
+    shard.bytes -= old_bytes;
+    bytes -= old_bytes;
+    shard.entries.pop_back();
+    shard.evictions++;
+  }
+
+  size_t max = max_bytes;
+  while(total > max && !max_bytes.compare_exchange_weak(max, total)) {}
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+CircuitCache::clear() {
+  for(auto& shard : shards) {
+    std::lock_guard<std::mutex> guard(shard.lock);
+    circuit_cache_hit_count += shard.hits;
+    circuit_cache_miss_count += shard.misses;
+    circuit_cache_eviction_count += shard.evictions;
+    shard.entries.clear();
+    shard.index.clear();
+    shard.bytes = shard.hits = shard.misses = shard.evictions = 0;
+  }
+  circuit_cache_bytes = bytes;
+  max_circuit_cache_bytes = max_bytes;
+  bytes = max_bytes = 0;
+}
+
+/*------------------------------------------------------------------------*/
+// Returns the offset of the value of key in the records of data, which are
+// indexed by index, 0 if missing
+static size_t
+find_record(const char* data,
+            const std::unordered_multimap<uint64_t, size_t>& index,
+            const std::string& key,
+            uint64_t hash,
+            uint32_t& value_size) {
+  auto range = index.equal_range(hash);
+  for(auto it = range.first; it != range.second; ++it) {
+    CacheReader in(data + it->second, record_header_size);
+    uint64_t h;
+    uint32_t key_size;
+    in.get(h);
+    in.get(key_size);
+    in.get(value_size);
+    const char* k = data + it->second + record_header_size;
+    if(key_size == key.size() && !memcmp(k, key.data(), key_size))
+      return it->second + record_header_size + key_size;
+  }
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+load_circuit_cache(const char* file_name) {
+  cache_name = file_name;
+  int fd = open(file_name, O_RDONLY);
+  if(fd < 0) {
+    if(errno != ENOENT)
+      die(err_cache_file, "cannot open cache file '%s'", file_name);
+    msg("cache file '%s' will be created", file_name);
+    return;
+  }
+
+  struct stat st;
+  if(fstat(fd, &st))
+    die(err_cache_file, "cannot read cache file '%s'", file_name);
+  cache_size = st.st_size;
+  if(cache_size) {
+    void* data = mmap(0, cache_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(data == MAP_FAILED)
+      die(err_cache_file, "cannot map cache file '%s'", file_name);
+    cache_data = static_cast<const char*>(data);
+  }
+  close(fd);
+
+  if(cache_size && (cache_size < magic_size || memcmp(cache_data, magic, magic_size)))
+    die(err_cache_file, "'%s' is no cache file of this version", file_name);
+
+  size_t pos = magic_size;
+  while(pos + record_header_size <= cache_size) {
+    CacheReader in(cache_data + pos, record_header_size);
+    uint64_t hash;
+    uint32_t key_size, value_size;
+    in.get(hash);
+    in.get(key_size);
+    in.get(value_size);
+    size_t next = pos + record_header_size + key_size + value_size;
+    if(next > cache_size)
+      break;
+    cache_index.emplace(hash, pos);
+    pos = next;
+  }
+  persistent_cache_size = cache_index.size();
+  msg("loaded %lu sub-circuits from cache file '%s'", cache_index.size(), file_name);
+}
+
+/*------------------------------------------------------------------------*/
+
+bool
+find_cached_circuit(const LinearizationContext& ctx,
+                    std::vector<compressed_polynomial>& res) {
+  if(!cache_data)
+    return 0;
+  std::string key = cache_key(ctx);
+  uint32_t value_size;
+  size_t offset
+    = find_record(cache_data, cache_index, key, hash_string(key), value_size);
+  if(!offset)
+    return 0;
+  CacheReader in(cache_data + offset, value_size);
+  if(!read_value(in, res))
+    die(err_cache_file, "corrupted record in cache file '%s'", cache_name);
+  persistent_cache_hit_count++;
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+store_cached_circuit(const LinearizationContext& ctx,
+                     const std::vector<compressed_polynomial>& res) {
+  if(!cache_name)
+    return;
+  std::string key = cache_key(ctx);
+  uint64_t hash = hash_string(key);
+  uint32_t value_size;
+  if(cache_data && find_record(cache_data, cache_index, key, hash, value_size))
+    return;
+  // entries evicted from the memory cache may be stored again
+  if(find_record(new_records.data(), new_index, key, hash, value_size))
+    return;
+  std::string value = cache_value(res);
+  new_index.emplace(hash, new_records.size());
+  put<uint64_t>(new_records, hash);
+  put<uint32_t>(new_records, key.size());
+  put<uint32_t>(new_records, value.size());
+  new_records += key;
+  new_records += value;
+  persistent_cache_store_count++;
+}
+
+/*------------------------------------------------------------------------*/
+
+// Returns the end of the last complete record of the cache file fd of the
+// given size, 0 if not even the magic string is complete
+static size_t
+complete_cache_size(int fd, size_t size) {
+  char header[record_header_size], start[magic_size];
+  if(size < magic_size)
+    return 0;
+  if(pread(fd, start, magic_size, 0) != static_cast<ssize_t>(magic_size)
+     || memcmp(start, magic, magic_size))
+    die(err_cache_file, "'%s' is no cache file of this version", cache_name);
+
+  size_t pos = magic_size;
+  while(pos + record_header_size <= size) {
+    if(pread(fd, header, record_header_size, pos)
+       != static_cast<ssize_t>(record_header_size))
+      die(err_cache_file, "cannot read cache file '%s'", cache_name);
+    CacheReader in(header, record_header_size);
+    uint64_t hash;
+    uint32_t key_size, value_size;
+    in.get(hash);
+    in.get(key_size);
+    in.get(value_size);
+    size_t next = pos + record_header_size + key_size + value_size;
+    if(next > size)
+      break;
+    pos = next;
+  }
+  return pos;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+save_circuit_cache() {
+  if(!cache_name)
+    return;
+  if(cache_data)
+    munmap(const_cast<char*>(cache_data), cache_size);
+  cache_data = 0;
+  cache_index.clear();
+  new_index.clear();
+  if(new_records.empty())
+    return;
+
+  // concurrent runs append whole blocks of records
+  int fd = open(cache_name, O_RDWR | O_CREAT | O_APPEND, 0644);
+  if(fd < 0 || flock(fd, LOCK_EX))
+    die(err_cache_file, "cannot write cache file '%s'", cache_name);
+  struct stat st;
+  if(fstat(fd, &st))
+    die(err_cache_file, "cannot write cache file '%s'", cache_name);
+
+  // a run that died while saving leaves a truncated record, which would
+  // misalign the records appended after it
+  size_t size = complete_cache_size(fd, st.st_size);
+  if(size < static_cast<size_t>(st.st_size) && ftruncate(fd, size))
+    die(err_cache_file, "cannot write cache file '%s'", cache_name);
+  if(!size)
+    new_records.insert(0, magic, magic_size);
+
+  const char* pos = new_records.data();
+  size_t left = new_records.size();
+  while(left) {
+    ssize_t n = write(fd, pos, left);
+    if(n < 0) {
+      if(errno == EINTR)
+        continue;
+      die(err_cache_file, "cannot write cache file '%s'", cache_name);
+    }
+    pos += n;
+    left -= n;
+  }
+  flock(fd, LOCK_UN);
+  close(fd);
+  new_records.clear();
+}
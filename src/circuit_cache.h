@@ -0,0 +1,136 @@
+/*------------------------------------------------------------------------*/
+/*! \file circuit_cache.h
+    \brief contains the caches of linearized sub-circuits
+
+  Linearized sub-circuits are cached in memory, bounded by a memory budget,
+  and optionally in an append-only file, such that runs on similar
+  circuits can reuse them. Every record is keyed by the
+  compressed sub-circuit together with the vanishing monomials among its
+  variables, which the linearization may have used. The file is mapped
+  into memory and indexed by a stable hash of the key at startup, the
+  circuits linearized in the current run are appended at exit.
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#ifndef TALISMAN_SRC_CIRCUIT_CACHE_H_
+#define TALISMAN_SRC_CIRCUIT_CACHE_H_
+/*------------------------------------------------------------------------*/
+#include <array>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "subcircuit.h"
+/*------------------------------------------------------------------------*/
+
+/** \class CircuitCache
+    Cache of linearized sub-circuits in memory. Keys and values are stored
+    in flat encoded strings. The cache is split into shards by the hash of
+    the key, each with its own lock and list of entries in the order of
+    their last use. If a shard exceeds its part of the memory budget, its
+    least recently used entries are evicted.
+*/
+class CircuitCache {
+  struct Entry {
+    uint64_t hash;
+    std::string key;
+    std::string value;
+  };
+
+  struct Shard {
+    std::mutex lock;
+
+    // / entries, the most recently used first
+    std::list<Entry> entries;
+
+    // / entries by hash of their key
+    std::unordered_multimap<uint64_t, std::list<Entry>::iterator> index;
+
+    // / memory used by the entries
+    size_t bytes = 0;
+
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+  };
+
+  static const size_t num_shards = 16;
+
+  std::array<Shard, num_shards> shards;
+
+  // / memory used by all shards, and its maximum
+  std::atomic<size_t> bytes = 0;
+  std::atomic<size_t> max_bytes = 0;
+
+  public:
+  /** Looks up the linear polynomials of a compressed sub-circuit
+
+      @param circuit compressed sub-circuit
+      @param res std::vector<compressed_polynomial>&, set if found
+
+      @return true if the sub-circuit is cached
+  */
+  bool find(const std::vector<Normalized_poly>& circuit,
+            std::vector<compressed_polynomial>& res);
+
+  /** Caches the linear polynomials of a compressed sub-circuit, replacing
+      a previous entry
+
+      @param circuit compressed sub-circuit
+      @param res linear polynomials of the sub-circuit
+  */
+  void insert(const std::vector<Normalized_poly>& circuit,
+              const std::vector<compressed_polynomial>& res);
+
+  /** Removes all entries and stores the counters of the cache in the
+      statistics
+  */
+  void clear();
+};
+
+// / linearized sub-circuits of this run
+extern CircuitCache cached_circuits;
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Maps the cache file into memory and builds its index. A missing file is
+    created when the cache is saved.
+
+    @param file_name const char*
+*/
+void load_circuit_cache(const char* file_name);
+
+/**
+    Looks up the linear polynomials of the sub-circuit of ctx in the cache
+    file
+
+    @param ctx LinearizationContext&
+    @param res std::vector<compressed_polynomial>&, set if found
+
+    @return true if the sub-circuit is cached
+*/
+bool find_cached_circuit(const LinearizationContext& ctx,
+                         std::vector<compressed_polynomial>& res);
+
+/**
+    Remembers the linear polynomials of the sub-circuit of ctx, which are
+    appended to the cache file when it is saved
+
+    @param ctx LinearizationContext&
+    @param res linear polynomials of the sub-circuit
+*/
+void store_cached_circuit(const LinearizationContext& ctx,
+                          const std::vector<compressed_polynomial>& res);
+
+/**
+    Appends the new sub-circuits to the cache file and unmaps it
+*/
+void save_circuit_cache();
+
+#endif// TALISMAN_SRC_CIRCUIT_CACHE_H_
@@ -0,0 +1,128 @@
+/*------------------------------------------------------------------------*/
+/*! \file cnf.cpp
+    \brief contains the CNF encoding of sub-circuits for guess-and-prove
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#include "cnf.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <pblib/pb2cnf.h>
+
+#include "signal_statistics.h"
+/*------------------------------------------------------------------------*/
+
+PbEncoding pb_encoding = PB_AUTO;
+
+// / largest weight that PB_AUTO encodes by a BDD
+static const int64_t bdd_max_weight = 16;
+
+static const char* pb_encoding_names[] = { "auto", "pblib",   "adder",
+                                           "bdd",  "sorting", "card" };
+
+/*------------------------------------------------------------------------*/
+
+bool
+parse_pb_encoding(const char* name, PbEncoding& res) {
+  for(int e = PB_AUTO; e <= PB_CARD; e++) {
+    if(!strcmp(name, pb_encoding_names[e])) {
+      res = static_cast<PbEncoding>(e);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+const char*
+pb_encoding_name(PbEncoding e) {
+  return pb_encoding_names[e];
+}
+
+/*------------------------------------------------------------------------*/
+
+// / CNF literal of each gate, zero for gates of no sub-circuit
+static thread_local std::vector<int> lit_of_gate;
+
+/*------------------------------------------------------------------------*/
+
+SubcircuitCnf::SubcircuitCnf(const std::vector<Var*>& vars)
+  : gate_of_var(1, nullptr) {
+  if(lit_of_gate.size() < size_gates)
+    lit_of_gate.resize(size_gates, 0);
+
+  for(const auto& v : vars) {
+    Gate* g = gate(v->get_num());
+    int& id = lit_of_gate[gate_index(v->get_num())];
+
+    // check that vars are unique
+    if(id)
+      die(4, "Gate %s already has id %i", g->get_var_name(), id);
+
+    id = gate_of_var.size();
+    gate_of_var.push_back(g);
+  }
+  first_fresh = gate_of_var.size();
+}
+
+/*------------------------------------------------------------------------*/
+
+SubcircuitCnf::~SubcircuitCnf() {
+  for(size_t var = 1; var < gate_of_var.size(); var++)
+    lit_of_gate[gate_index(gate_of_var[var]->get_var_num())] = 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+SubcircuitCnf::lit(const Gate* g) const {
+  return lit_of_gate[gate_index(g->get_var_num())];
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+encode_geq(const std::vector<int64_t>& weights,
+           const std::vector<int>& lits,
+           int64_t geq,
+           ClauseArena& res,
+           int first_fresh) {
+  PbEncoding e = pb_encoding;
+  if(e == PB_AUTO) {
+    int64_t max_weight = 0;
+    for(const auto& w : weights)
+      max_weight = std::max(max_weight, std::abs(w));
+    if(max_weight <= 1)
+      e = PB_CARD;
+    else if(max_weight <= bdd_max_weight)
+      e = PB_BDD;
+    else
+      e = PB_ADDER;
+  }
+
+  // pblib encodes constraints with equal weights as cardinality
+  // constraints, the PB encoder is only used for different weights
+  PBConfig config = std::make_shared<PBConfigClass>();
+  switch(e) {
+  case PB_ADDER: config->pb_encoder = PB_ENCODER::ADDER; break;
+  case PB_BDD:
+    config->pb_encoder = PB_ENCODER::BDD;
+    config->amk_encoder = AMK_ENCODER::BDD;
+    break;
+  case PB_SORTING: config->pb_encoder = PB_ENCODER::SORTINGNETWORKS; break;
+  case PB_CARD: config->amk_encoder = AMK_ENCODER::CARD; break;
+  default: break;
+  }
+
+  PB2CNF pb2cnf(config);
+  std::vector<std::vector<int32_t>> clauses;
+  pb2cnf.encodeGeq(weights, lits, geq, clauses, first_fresh);
+  res.add_clauses(clauses);
+  guess_clause_count += clauses.size();
+}
@@ -0,0 +1,202 @@
+/*------------------------------------------------------------------------*/
+/*! \file cnf.h
+    \brief contains the CNF encoding of sub-circuits for guess-and-prove
+
+  Every guessed relation of a sub-circuit is proven by kissat on the
+  encoding of the same gates. The gates are hence encoded once into a
+  contiguous clause arena, and every guess only adds a small arena of
+  clauses for its relation, which kissat reads after the shared one.
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#ifndef TALISMAN_SRC_CNF_H_
+#define TALISMAN_SRC_CNF_H_
+/*------------------------------------------------------------------------*/
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "gate.h"
+/*------------------------------------------------------------------------*/
+
+// / encodings of the linear constraint of a guess
+enum PbEncoding {
+  PB_AUTO,    // chosen by the coefficients, see encode_geq()
+  PB_PBLIB,   // default configuration of pblib
+  PB_ADDER,   // adder network
+  PB_BDD,     // binary decision diagram
+  PB_SORTING, // sorting network
+  PB_CARD     // cardinality network, only for unit coefficients
+};
+
+// / selected encoding of the linear constraint of a guess
+extern PbEncoding pb_encoding;
+
+/**
+    Parses the name of an encoding
+
+    @param name auto, pblib, adder, bdd, sorting or card
+    @param res parsed PbEncoding
+
+    @return false if the name is unknown
+*/
+bool parse_pb_encoding(const char* name, PbEncoding& res);
+
+/**
+    Returns the name of an encoding
+
+    @param e PbEncoding
+
+    @return const char*
+*/
+const char* pb_encoding_name(PbEncoding e);
+
+/*------------------------------------------------------------------------*/
+
+/** \class ClauseArena
+    Clauses stored one after another, every clause is terminated by 0 like
+    in the input of kissat.
+*/
+class ClauseArena {
+  // / literals of all clauses including the terminating zeros
+  std::vector<int> lits;
+
+  // / number of clauses
+  size_t num_clauses = 0;
+
+  public:
+  /** Appends a clause
+
+      @param clause literals, not containing 0
+  */
+  void add_clause(std::initializer_list<int> clause) {
+    lits.insert(lits.end(), clause);
+    lits.push_back(0);
+    num_clauses++;
+  }
+
+  /** Appends clauses in the format of pblib
+
+      @param clauses std::vector<std::vector<int32_t>>
+  */
+  void add_clauses(const std::vector<std::vector<int32_t>>& clauses) {
+    for(const auto& clause : clauses) {
+      lits.insert(lits.end(), clause.begin(), clause.end());
+      lits.push_back(0);
+    }
+    num_clauses += clauses.size();
+  }
+
+  /** Getter for the number of clauses
+
+      @return size_t
+  */
+  size_t size() const { return num_clauses; }
+
+  /** Getter for the literals including the terminating zeros
+
+      @return const std::vector<int>&
+  */
+  const std::vector<int>& literals() const { return lits; }
+};
+
+/*------------------------------------------------------------------------*/
+
+/** \class SubcircuitCnf
+    CNF variables and clauses of the gates of a sub-circuit. The variables
+    are numbered 1, ..., max_lit() and the CNF literal of a gate is looked
+    up in a table indexed by gate_index(), which is shared by all
+    encodings of a thread and reset by the destructor.
+*/
+class SubcircuitCnf {
+  // / gate of each variable, the first entry is unused
+  std::vector<Gate*> gate_of_var;
+
+  // / encoding of the gates
+  ClauseArena aig;
+
+  // / first variable that is not used by the encoding of the gates
+  int first_fresh;
+
+  public:
+  /** Constructor, numbers the variables in the given order
+
+      @param vars variables of the gates of the sub-circuit
+  */
+  explicit SubcircuitCnf(const std::vector<Var*>& vars);
+
+  SubcircuitCnf(const SubcircuitCnf&) = delete;
+
+  ~SubcircuitCnf();
+
+  /** Getter for the CNF literal of a gate
+
+      @param g Gate* of the sub-circuit
+
+      @return positive integer
+  */
+  int lit(const Gate* g) const;
+
+  /** Getter for the number of variables of the gates
+
+      @return int
+  */
+  int max_lit() const { return gate_of_var.size() - 1; }
+
+  /** Getter for the gate of a CNF variable
+
+      @param var 1, ..., max_lit()
+
+      @return Gate*
+  */
+  Gate* gate_of(int var) const { return gate_of_var[var]; }
+
+  /** Getter for the encoding of the gates
+
+      @return ClauseArena&
+  */
+  ClauseArena& clauses() { return aig; }
+  const ClauseArena& clauses() const { return aig; }
+
+  /** Getter for the first auxiliary variable of additional clauses
+
+      @return int
+  */
+  int get_first_fresh() const { return first_fresh; }
+
+  /** Encodes the AND gate lhs = rhs0 & rhs1 by its three Tseitin clauses
+
+      @param lhs CNF literal of the gate
+      @param rhs0 CNF literal of the first input
+      @param rhs1 CNF literal of the second input
+  */
+  void add_and(int lhs, int rhs0, int rhs1) {
+    aig.add_clause({ -lhs, rhs0 });
+    aig.add_clause({ -lhs, rhs1 });
+    aig.add_clause({ lhs, -rhs0, -rhs1 });
+  }
+};
+
+/*------------------------------------------------------------------------*/
+
+/**
+    Encodes sum weights_i * lits_i >= geq by pblib. With PB_AUTO, unit
+    weights are encoded by a cardinality network, small weights by a BDD
+    and larger ones, like the powers of two of adder relations, by an
+    adder network, whose size only grows logarithmically in the weights.
+
+    @param weights nonzero coefficients
+    @param lits CNF literals
+    @param geq right-hand side
+    @param res arena the clauses are added to
+    @param first_fresh first auxiliary variable
+*/
+void encode_geq(const std::vector<int64_t>& weights,
+                const std::vector<int>& lits,
+                int64_t geq,
+                ClauseArena& res,
+                int first_fresh);
+
+#endif// TALISMAN_SRC_CNF_H_
@@ -0,0 +1,252 @@
+/*------------------------------------------------------------------------*/
+/*! \file coefficient.cpp
+    \brief contains the class Coeff, used for coefficients of monomials
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#include "coefficient.h"
+
+#include <cinttypes>
+/*------------------------------------------------------------------------*/
+static_assert(sizeof(long) == sizeof(int64_t),
+  "inline coefficients are converted using the 'si' functions of GMP");
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::clear_big() {
+  mpz_clear(big);
+  delete big;
+  big = 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+mpz_srcptr
+Coeff::view(mpz_ptr tmp) const {
+  if(big)
+    return big;
+  mpz_set_si(tmp, small);
+  return tmp;
+}
+
+/*------------------------------------------------------------------------*/
+
+Coeff&
+Coeff::operator=(const Coeff& c) {
+  if(this == &c)
+    return *this;
+  if(c.big)
+    set(c.big);
+  else
+    set_si(c.small);
+  return *this;
+}
+
+/*------------------------------------------------------------------------*/
+
+int64_t
+Coeff::get_si() const {
+  return big ? mpz_get_si(big) : small;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::get_mpz(mpz_ptr out) const {
+  if(big)
+    mpz_set(out, big);
+  else
+    mpz_set_si(out, small);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::set(mpz_srcptr v) {
+  if(mpz_fits_slong_p(v)) {
+    int64_t tmp = mpz_get_si(v);
+    set_si(tmp);
+  } else {
+    if(!big) {
+      big = new __mpz_struct;
+      mpz_init(big);
+    }
+    mpz_set(big, v);
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+Coeff::sgn() const {
+  if(big)
+    return mpz_sgn(big);
+  return (small > 0) - (small < 0);
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+Coeff::cmp(const Coeff& c) const {
+  if(!big && !c.big)
+    return (small > c.small) - (small < c.small);
+  if(big && c.big)
+    return mpz_cmp(big, c.big);
+  // promoted values are larger in absolute value than any inline value
+  return big ? mpz_sgn(big) : -mpz_sgn(c.big);
+}
+
+/*------------------------------------------------------------------------*/
+
+int
+Coeff::cmp_si(int64_t v) const {
+  if(big)
+    return mpz_sgn(big);
+  return (small > v) - (small < v);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::add_slow(const Coeff& a, const Coeff& b) {
+  mpz_t x, y;
+  mpz_init(x);
+  mpz_init(y);
+  mpz_add(x, a.view(x), b.view(y));
+  set(x);
+  mpz_clear(x);
+  mpz_clear(y);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::mul_slow(const Coeff& a, const Coeff& b) {
+  mpz_t x, y;
+  mpz_init(x);
+  mpz_init(y);
+  mpz_mul(x, a.view(x), b.view(y));
+  set(x);
+  mpz_clear(x);
+  mpz_clear(y);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::addmul_slow(const Coeff& a, const Coeff& b) {
+  mpz_t r, x, y;
+  mpz_init(r);
+  mpz_init(x);
+  mpz_init(y);
+  get_mpz(r);
+  mpz_addmul(r, a.view(x), b.view(y));
+  set(r);
+  mpz_clear(r);
+  mpz_clear(x);
+  mpz_clear(y);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::neg_slow(const Coeff& a) {
+  mpz_t x;
+  mpz_init(x);
+  mpz_neg(x, a.view(x));
+  set(x);
+  mpz_clear(x);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::tdiv_slow(const Coeff& a, const Coeff& b, bool rem) {
+  mpz_t x, y;
+  mpz_init(x);
+  mpz_init(y);
+  mpz_srcptr n = a.view(x), d = b.view(y);
+  if(rem)
+    mpz_tdiv_r(x, n, d);
+  else
+    mpz_tdiv_q(x, n, d);
+  set(x);
+  mpz_clear(x);
+  mpz_clear(y);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::tdiv_q(const Coeff& a, const Coeff& b) {
+  if(!a.big && !b.big && !(a.small == INT64_MIN && b.small == -1))
+    set_si(a.small / b.small);
+  else
+    tdiv_slow(a, b, 0);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::tdiv_r(const Coeff& a, const Coeff& b) {
+  if(!a.big && !b.big && !(a.small == INT64_MIN && b.small == -1))
+    set_si(a.small % b.small);
+  else
+    tdiv_slow(a, b, 1);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::tdiv_2exp_slow(const Coeff& a, unsigned exp, bool rem) {
+  mpz_t x;
+  mpz_init(x);
+  if(rem)
+    mpz_tdiv_r_2exp(x, a.view(x), exp);
+  else
+    mpz_tdiv_q_2exp(x, a.view(x), exp);
+  set(x);
+  mpz_clear(x);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::tdiv_q_2exp(const Coeff& a, unsigned exp) {
+  if(a.big) {
+    tdiv_2exp_slow(a, exp, 0);
+    return;
+  }
+  uint64_t u = a.small < 0 ? 0 - (uint64_t)a.small : (uint64_t)a.small;
+  u = exp < 64 ? u >> exp : 0;
+  set_si(a.small < 0 ? (int64_t)(0 - u) : (int64_t)u);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::tdiv_r_2exp(const Coeff& a, unsigned exp) {
+  if(a.big) {
+    tdiv_2exp_slow(a, exp, 1);
+    return;
+  }
+  if(exp >= 64) {
+    set_si(a.small);
+    return;
+  }
+  uint64_t u = a.small < 0 ? 0 - (uint64_t)a.small : (uint64_t)a.small;
+  u &= ((uint64_t)1 << exp) - 1;
+  set_si(a.small < 0 ? (int64_t)(0 - u) : (int64_t)u);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Coeff::print(FILE* file) const {
+  if(big)
+    mpz_out_str(file, 10, big);
+  else
+    fprintf(file, "%" PRId64, small);
+}
@@ -0,0 +1,187 @@
+/*------------------------------------------------------------------------*/
+/*! \file coefficient.h
+    \brief contains the class Coeff, used for coefficients of monomials
+
+  Almost all coefficients occurring in multiplier verification fit into
+  64 bits. Hence coefficients are stored inline as int64_t and are only
+  promoted to a GMP integer if a result does not fit into 64 bits.
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#ifndef TALISMAN_SRC_COEFFICIENT_H_
+#define TALISMAN_SRC_COEFFICIENT_H_
+/*------------------------------------------------------------------------*/
+#include <gmp.h>
+
+#include <cstdint>
+#include <cstdio>
+/*------------------------------------------------------------------------*/
+
+/** \class Coeff
+    Integer coefficient with an inline 64-bit fast path. The GMP integer
+    'big' is allocated if and only if the value does not fit into 'small',
+    thus every value has a unique representation.
+
+    Arithmetic follows the GMP convention, i.e., the result is stored in
+    the calling object, e.g. c.add(a, b) sets c = a + b.
+*/
+class Coeff {
+  // / value of the coefficient, valid if big is 0
+  int64_t small = 0;
+
+  // / promoted value, 0 as long as the value fits into small
+  mpz_ptr big = 0;
+
+  void clear_big();
+  mpz_srcptr view(mpz_ptr tmp) const;
+
+  void add_slow(const Coeff& a, const Coeff& b);
+  void mul_slow(const Coeff& a, const Coeff& b);
+  void addmul_slow(const Coeff& a, const Coeff& b);
+  void neg_slow(const Coeff& a);
+  void tdiv_slow(const Coeff& a, const Coeff& b, bool rem);
+  void tdiv_2exp_slow(const Coeff& a, unsigned exp, bool rem);
+
+  public:
+  /** Constructor, initializes the coefficient to 0 */
+  Coeff() {}
+
+  /** Constructor
+
+      @param v int64_t value
+  */
+  Coeff(int64_t v)
+    : small(v) {}
+
+  /** Constructor
+
+      @param v mpz_srcptr value
+  */
+  explicit Coeff(mpz_srcptr v) { set(v); }
+
+  /** Copy constructor */
+  Coeff(const Coeff& c) { *this = c; }
+
+  /** Assignment operator */
+  Coeff& operator=(const Coeff& c);
+
+  /** Destructor */
+  ~Coeff() {
+    if(big)
+      clear_big();
+  }
+
+  /** Returns whether the value is stored inline
+
+      @return bool
+  */
+  bool fits_si() const { return !big; }
+
+  /** Getter for the inline value, truncated like mpz_get_si otherwise
+
+      @return int64_t
+  */
+  int64_t get_si() const;
+
+  /** Stores the value in a GMP integer
+
+      @param out mpz_ptr, needs to be initialized
+  */
+  void get_mpz(mpz_ptr out) const;
+
+  /** Setter
+
+      @param v mpz_srcptr
+  */
+  void set(mpz_srcptr v);
+
+  /** Setter
+
+      @param v int64_t
+  */
+  void set_si(int64_t v) {
+    if(big)
+      clear_big();
+    small = v;
+  }
+
+  /** Returns the sign of the coefficient
+
+      @return -1, 0 or 1
+  */
+  int sgn() const;
+
+  /** Compares the coefficient to c
+
+      @param c const Coeff&
+
+      @return negative, zero or positive value like mpz_cmp
+  */
+  int cmp(const Coeff& c) const;
+
+  /** Compares the coefficient to v
+
+      @param v int64_t
+
+      @return negative, zero or positive value like mpz_cmp_si
+  */
+  int cmp_si(int64_t v) const;
+
+  /** Sets the coefficient to a + b */
+  void add(const Coeff& a, const Coeff& b) {
+    int64_t r;
+    if(!a.big && !b.big && !__builtin_add_overflow(a.small, b.small, &r))
+      set_si(r);
+    else
+      add_slow(a, b);
+  }
+
+  /** Sets the coefficient to a * b */
+  void mul(const Coeff& a, const Coeff& b) {
+    int64_t r;
+    if(!a.big && !b.big && !__builtin_mul_overflow(a.small, b.small, &r))
+      set_si(r);
+    else
+      mul_slow(a, b);
+  }
+
+  /** Adds a * b to the coefficient */
+  void addmul(const Coeff& a, const Coeff& b) {
+    int64_t r;
+    if(!big && !a.big && !b.big && !__builtin_mul_overflow(a.small, b.small, &r)
+       && !__builtin_add_overflow(small, r, &r))
+      small = r;
+    else
+      addmul_slow(a, b);
+  }
+
+  /** Sets the coefficient to -a */
+  void neg(const Coeff& a) {
+    if(!a.big && a.small != INT64_MIN)
+      set_si(-a.small);
+    else
+      neg_slow(a);
+  }
+
+  /** Sets the coefficient to the quotient of a / b, rounded towards zero */
+  void tdiv_q(const Coeff& a, const Coeff& b);
+
+  /** Sets the coefficient to the remainder of a / b, sign of a */
+  void tdiv_r(const Coeff& a, const Coeff& b);
+
+  /** Sets the coefficient to the quotient of a / 2^exp, rounded towards zero */
+  void tdiv_q_2exp(const Coeff& a, unsigned exp);
+
+  /** Sets the coefficient to the remainder of a / 2^exp, sign of a */
+  void tdiv_r_2exp(const Coeff& a, unsigned exp);
+
+  /** Printing routine
+
+      @param file Output file
+  */
+  void print(FILE* file) const;
+};
+
+#endif// TALISMAN_SRC_COEFFICIENT_H_
@@ -0,0 +1,112 @@
+/*------------------------------------------------------------------------*/
+/*! \file coefficient_ring.cpp
+    \brief contains coefficient rings used for linear remainders
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#include "coefficient_ring.h"
+/*------------------------------------------------------------------------*/
+
+void
+coeff_to_limbs(mp_limb_t* r, const Coeff& c, size_t n) {
+  if(c.fits_si()) {
+    int64_t v = c.get_si();
+    r[0] = (mp_limb_t)v;
+    for(size_t i = 1; i < n; i++)
+      r[i] = v < 0 ? ~(mp_limb_t)0 : 0;
+    return;
+  }
+  mpz_t tmp;
+  mpz_init(tmp);
+  c.get_mpz(tmp);
+  mpz_fdiv_r_2exp(tmp, tmp, 64 * n);
+  for(size_t i = 0; i < n; i++)
+    r[i] = mpz_getlimbn(tmp, i);
+  mpz_clear(tmp);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+limbs_to_coeff(Coeff& out, const mp_limb_t* a, size_t n, unsigned exp) {
+  bool neg = (a[(exp - 1) / 64] >> ((exp - 1) % 64)) & 1;
+
+  if(exp <= 64) {
+    // sign extension of the residue in the lowest limb
+    uint64_t v = a[0];
+    if(neg && exp < 64)
+      v |= ~(uint64_t)0 << exp;
+    out.set_si((int64_t)v);
+    return;
+  }
+
+  mpz_t tmp;
+  mpz_init(tmp);
+  mpz_import(tmp, n, -1, sizeof(mp_limb_t), 0, 0, a);
+  mpz_fdiv_r_2exp(tmp, tmp, exp);
+  if(neg) {
+    mpz_t mod;
+    mpz_init(mod);
+    mpz_setbit(mod, exp);
+    mpz_sub(tmp, tmp, mod);
+    mpz_clear(mod);
+  }
+  out.set(tmp);
+  mpz_clear(tmp);
+}
+
+/*------------------------------------------------------------------------*/
+
+bool
+neg_quotient_limbs(mp_limb_t* q, const mp_limb_t* c, const Coeff& lc, size_t n, unsigned exp) {
+  mpz_t cz, l, mod;
+  mpz_init(cz);
+  mpz_init(l);
+  mpz_init(mod);
+
+  mpz_import(cz, n, -1, sizeof(mp_limb_t), 0, 0, c);
+  lc.get_mpz(l);
+  mpz_fdiv_r_2exp(l, l, exp);
+
+  // lc = 2^k * u with u odd, hence c needs to be divisible by 2^k
+  bool res = mpz_sgn(l) != 0;
+  if(res) {
+    mp_bitcnt_t k = mpz_scan1(l, 0);
+    res = mpz_scan1(cz, 0) >= k;
+    if(res) {
+      mpz_tdiv_q_2exp(l, l, k);
+      mpz_tdiv_q_2exp(cz, cz, k);
+      mpz_setbit(mod, exp);
+      mpz_invert(l, l, mod);
+      mpz_mul(cz, cz, l);
+      mpz_neg(cz, cz);
+      mpz_fdiv_r_2exp(cz, cz, exp);
+      for(size_t i = 0; i < n; i++)
+        q[i] = mpz_getlimbn(cz, i);
+    }
+  }
+
+  mpz_clear(cz);
+  mpz_clear(l);
+  mpz_clear(mod);
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+bool
+GmpRing::neg_quotient(Coeff& q, const Coeff& c, const Coeff& lc) const {
+  if(c.cmp(lc) == 0) {
+    q.set_si(-1);
+    return 1;
+  }
+  Coeff rest;
+  rest.tdiv_r(c, lc);
+  if(rest.sgn() != 0)
+    return 0;
+  q.tdiv_q(c, lc);
+  q.neg(q);
+  return 1;
+}
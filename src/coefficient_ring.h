@@ -0,0 +1,234 @@
+/*------------------------------------------------------------------------*/
+/*! \file coefficient_ring.h
+    \brief contains coefficient rings used for linear remainders
+
+  The remainder of the reduction is only needed modulo 2^NN. Instead of
+  GMP integers that are truncated explicitly, its coefficients can be
+  stored in a machine word or in a fixed array of limbs, where truncation
+  is a single mask. All rings provide the same interface, such that the
+  LinearRemainder can be instantiated with either of them.
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#ifndef TALISMAN_SRC_COEFFICIENT_RING_H_
+#define TALISMAN_SRC_COEFFICIENT_RING_H_
+/*------------------------------------------------------------------------*/
+#include <array>
+#include <cstring>
+
+#include "coefficient.h"
+/*------------------------------------------------------------------------*/
+
+typedef unsigned __int128 uint128_t;
+
+static_assert(sizeof(mp_limb_t) == sizeof(uint64_t), "limbs need to have 64 bits");
+
+/*------------------------------------------------------------------------*/
+// Conversions between Coeff and residues that are stored in n limbs
+
+/**
+    Stores c modulo 2^(64n) in the limbs r[0], ..., r[n-1]
+
+    @param r mp_limb_t* output
+    @param c const Coeff&
+    @param n number of limbs
+*/
+void
+coeff_to_limbs(mp_limb_t* r, const Coeff& c, size_t n);
+
+/**
+    Sets out to the representative of the residue a modulo 2^exp in the
+    interval [-2^(exp-1), 2^(exp-1))
+
+    @param out Coeff&
+    @param a const mp_limb_t*, residue in n limbs
+    @param n number of limbs
+    @param exp exponent of the modulus
+*/
+void
+limbs_to_coeff(Coeff& out, const mp_limb_t* a, size_t n, unsigned exp);
+
+/**
+    Computes q such that c + q*lc = 0 modulo 2^exp
+
+    @param q mp_limb_t* output, n limbs
+    @param c const mp_limb_t*, residue in n limbs
+    @param lc const Coeff&
+    @param n number of limbs
+    @param exp exponent of the modulus
+
+    @return false if no such q exists
+*/
+bool
+neg_quotient_limbs(mp_limb_t* q, const mp_limb_t* c, const Coeff& lc, size_t n, unsigned exp);
+
+/*------------------------------------------------------------------------*/
+
+/** \class GmpRing
+    Integer coefficients, which are truncated modulo 2^exp in reduce().
+    Quotients are exact integer quotients.
+*/
+class GmpRing {
+  unsigned exp;
+
+  public:
+  typedef Coeff value;
+
+  explicit GmpRing(unsigned e)
+    : exp(e) {}
+
+  const char* name() const { return "GMP integers"; }
+
+  bool is_zero(const Coeff& a) const { return a.sgn() == 0; }
+
+  void add(Coeff& r, const Coeff& c) const { r.add(r, c); }
+
+  void addmul(Coeff& r, const Coeff& q, const Coeff& c) const { r.addmul(q, c); }
+
+  void reduce(Coeff& r) const { r.tdiv_r_2exp(r, exp); }
+
+  bool neg_quotient(Coeff& q, const Coeff& c, const Coeff& lc) const;
+
+  void store(Coeff& out, const Coeff& a) const { out = a; }
+};
+
+/*------------------------------------------------------------------------*/
+
+/** \class WordRing
+    Residues modulo 2^exp stored in an unsigned machine word W with at
+    least exp bits. Every operation is truncated by a mask, reduce() is
+    empty.
+*/
+template<typename W>
+class WordRing {
+  static const size_t limbs = sizeof(W) / sizeof(mp_limb_t);
+
+  unsigned exp;
+  W mask;
+
+  W load(const Coeff& c) const {
+    if(c.fits_si())
+      return (W)c.get_si() & mask;
+    mp_limb_t l[limbs];
+    coeff_to_limbs(l, c, limbs);
+    W r;
+    memcpy(&r, l, sizeof(W));
+    return r & mask;
+  }
+
+  public:
+  typedef W value;
+
+  explicit WordRing(unsigned e)
+    : exp(e)
+    , mask(e < 8 * sizeof(W) ? ((W)1 << e) - 1 : ~(W)0) {}
+
+  const char* name() const { return sizeof(W) == 8 ? "64-bit words" : "128-bit words"; }
+
+  bool is_zero(const W& a) const { return !a; }
+
+  void add(W& r, const Coeff& c) const { r = (r + load(c)) & mask; }
+
+  void addmul(W& r, const W& q, const Coeff& c) const { r = (r + q * load(c)) & mask; }
+
+  void reduce(W&) const {}
+
+  bool neg_quotient(W& q, const W& c, const Coeff& lc) const {
+    W l = load(lc);
+    if(l == 1) {
+      q = (0 - c) & mask;
+      return 1;
+    }
+    if(l == mask) {
+      q = c;
+      return 1;
+    }
+    mp_limb_t ql[limbs], cl[limbs];
+    memcpy(cl, &c, sizeof(W));
+    if(!neg_quotient_limbs(ql, cl, lc, limbs, exp))
+      return 0;
+    memcpy(&q, ql, sizeof(W));
+    return 1;
+  }
+
+  void store(Coeff& out, const W& a) const {
+    mp_limb_t l[limbs];
+    memcpy(l, &a, sizeof(W));
+    limbs_to_coeff(out, l, limbs, exp);
+  }
+};
+
+/*------------------------------------------------------------------------*/
+
+/** \class LimbRing
+    Residues modulo 2^exp stored in L limbs, used if exp exceeds 128 bits.
+    Limbs above bit exp are kept zero.
+*/
+template<size_t L>
+class LimbRing {
+  unsigned exp;
+
+  void truncate(mp_limb_t* r) const {
+    size_t top = exp / 64;
+    if(top >= L)
+      return;
+    r[top] &= ((mp_limb_t)1 << (exp % 64)) - 1;
+    for(size_t i = top + 1; i < L; i++)
+      r[i] = 0;
+  }
+
+  public:
+  typedef std::array<mp_limb_t, L> value;
+
+  explicit LimbRing(unsigned e)
+    : exp(e) {}
+
+  const char* name() const { return "fixed limbs"; }
+
+  bool is_zero(const value& a) const { return mpn_zero_p(a.data(), L); }
+
+  void add(value& r, const Coeff& c) const {
+    value t;
+    coeff_to_limbs(t.data(), c, L);
+    mpn_add_n(r.data(), r.data(), t.data(), L);
+    truncate(r.data());
+  }
+
+  void addmul(value& r, const value& q, const Coeff& c) const {
+    if(c.fits_si() && c.get_si() != INT64_MIN) {
+      int64_t v = c.get_si();
+      if(v > 0)
+        mpn_addmul_1(r.data(), q.data(), L, v);
+      else if(v < 0)
+        mpn_submul_1(r.data(), q.data(), L, -v);
+    } else {
+      value t;
+      mp_limb_t p[2 * L];
+      coeff_to_limbs(t.data(), c, L);
+      mpn_mul_n(p, q.data(), t.data(), L);
+      mpn_add_n(r.data(), r.data(), p, L);
+    }
+    truncate(r.data());
+  }
+
+  void reduce(value&) const {}
+
+  bool neg_quotient(value& q, const value& c, const Coeff& lc) const {
+    if(lc.cmp_si(1) == 0) {
+      mpn_neg(q.data(), c.data(), L);
+      truncate(q.data());
+      return 1;
+    }
+    if(lc.cmp_si(-1) == 0) {
+      q = c;
+      return 1;
+    }
+    return neg_quotient_limbs(q.data(), c.data(), lc, L, exp);
+  }
+
+  void store(Coeff& out, const value& a) const { limbs_to_coeff(out, a.data(), L, exp); }
+};
+
+#endif// TALISMAN_SRC_COEFFICIENT_RING_H_
@@ -15,22 +15,22 @@
 #include <stdio.h>
 
 #include <ranges>
+#include <thread>
 #include <unordered_map>
 #include <unordered_set>
 
+#include "circuit_cache.h"
 #include "gmp.h"
 #include "matrix.h"
 #include "polynomial.h"
 #include "reductionmethods.h"
 #include "signal_statistics.h"
+#include "sparse_matrix.h"
 #include "subcircuit.h"
 #include "substitution.h"
 
 #include <iostream>
 
-typedef std::vector<std::pair<mpz_class, size_t>> compressed_polynomial;
-std::vector<std::vector<int>> indices;
-
 compressed_polynomial
 compress_linear(Polynomial* g, std::map<Var*, size_t>& var_to_id) {
   assert(g->degree() <= 1);
@@ -38,12 +38,178 @@ compress_linear(Polynomial* g, std::map<Var*, size_t>& var_to_id) {
   compressed_polynomial p;
   for(size_t j = 0; j < g->len(); j++) {
     Monomial* m = g->get_mon(j);
-    mpz_class c(m->coeff);
+    mpz_class c;
+    m->get_coeff().get_mpz(c.get_mpz_t());
     size_t id = m->get_term() ? var_to_id[m->get_term()->get_var()] : 0;
     p.emplace_back(c, id);
   }
   return p;
 }
+/*------------------------------------------------------------------------*/
+// Speculative selection of sub-circuits
+/*------------------------------------------------------------------------*/
+
+/** \struct LinearizationConfig
+    Parameters of a single call of internal_linearize.
+*/
+struct LinearizationConfig {
+  int depth;
+  size_t fanout_size;
+  int init;
+  bool single_expand;
+
+  bool operator==(const LinearizationConfig&) const = default;
+};
+
+/** \struct SpeculativeSubcircuit
+    Sub-circuit of the next linearization attempt. It is selected while
+    the kernel of the current attempt is computed by a worker thread, and
+    it is only used if the current attempt does not linearize the root
+    gate. Otherwise the speculation is discarded, so that the results are
+    identical to the sequential search.
+
+    Only the selection of the next attempt overlaps the kernel of the
+    current one, the attempts themselves are not run concurrently. They
+    share the normal forms of the gates, the term table and the caches,
+    and every attempt depends on the normal forms set by the previous ones.
+*/
+struct SpeculativeSubcircuit {
+  // / configuration of the next attempt
+  LinearizationConfig config;
+
+  // / true if the next attempt shall be selected speculatively
+  bool requested = 0;
+
+  // / true if the sub-circuit of config has been selected
+  bool ready = 0;
+
+  // / result of get_and_compress_subcircuit
+  bool found = 0;
+
+  // / selected sub-circuit, only the sub-circuit members are used
+  LinearizationContext ctx;
+
+  // / gates whose normal form was set by the speculation
+  std::vector<Gate*> new_nf;
+};
+
+/*------------------------------------------------------------------------*/
+static void
+select_speculative_subcircuit(LinearizationContext& ctx,
+                              Gate* g,
+                              SpeculativeSubcircuit& spec) {
+  const LinearizationConfig& c = spec.config;
+  spec.ctx.gate_poly = ctx.gate_poly;
+  spec.ctx.var = ctx.var;
+  spec.ctx.sc_inputs = ctx.sc_inputs;
+  spec.ctx.fanout_size_last_call = ctx.fanout_size_last_call;
+  spec.ctx.var_to_id.clear();
+  spec.ctx.circuit.clear();
+
+  spec.found = get_and_compress_subcircuit(
+    spec.ctx, g, c.depth, c.fanout_size, c.init, c.single_expand, &spec.new_nf);
+  spec.ready = 1;
+  spec.requested = 0;
+}
+
+/*------------------------------------------------------------------------*/
+static void
+discard_speculation(SpeculativeSubcircuit& spec) {
+  for(auto& gatep : spec.new_nf) {
+    delete(gatep->get_nf());
+    gatep->set_nf(0);
+  }
+  spec.new_nf.clear();
+  spec.ready = 0;
+}
+
+/*------------------------------------------------------------------------*/
+static void
+adopt_speculation(LinearizationContext& ctx, SpeculativeSubcircuit& spec) {
+  std::swap(ctx.gate_poly, spec.ctx.gate_poly);
+  std::swap(ctx.var, spec.ctx.var);
+  std::swap(ctx.sc_inputs, spec.ctx.sc_inputs);
+  std::swap(ctx.circuit, spec.ctx.circuit);
+  std::swap(ctx.var_to_id, spec.ctx.var_to_id);
+  ctx.unlabeled_hash = spec.ctx.unlabeled_hash;
+  ctx.fanout_size_last_call = spec.ctx.fanout_size_last_call;
+  spec.new_nf.clear();
+  spec.ready = 0;
+}
+
+/*------------------------------------------------------------------------*/
+// Incremental elimination of the matrices of fglm
+/*------------------------------------------------------------------------*/
+// Row of a term, which is referenced until the context is released
+static size_t
+term_row(LinearizationContext& ctx, Term* t) {
+  auto [it, inserted] = ctx.term_rows.emplace(t, ctx.term_rows.size());
+  if(inserted && t)
+    t->copy();
+  return it->second;
+}
+
+/*------------------------------------------------------------------------*/
+static bool
+equal_columns(const SparseRow& a, const SparseRow& b) {
+  if(a.size() != b.size())
+    return false;
+  for(size_t i = 0; i < a.size(); i++)
+    if(a[i].first != b[i].first || a[i].second.cmp(b[i].second))
+      return false;
+  return true;
+}
+
+/*------------------------------------------------------------------------*/
+// Computes the kernel of the matrix with the given columns. The elimination
+// of the previous matrix is kept up to its first column that was changed by
+// the enlargement of the subcircuit, only the remaining columns are reduced.
+static void
+reuse_elimination(LinearizationContext& ctx,
+                  const std::vector<std::pair<size_t, bool>>& keys,
+                  const std::vector<SparseRow>& columns,
+                  fmpz_mat_t K) {
+  IncrementalKernel& elim = ctx.elimination;
+  std::vector<std::pair<size_t, bool>>& elim_keys = ctx.elimination_keys;
+
+  std::map<std::pair<size_t, bool>, size_t> column_of;
+  for(size_t j = 0; j < keys.size(); j++)
+    column_of[keys[j]] = j;
+
+  std::vector<long> position;
+  std::vector<bool> added(keys.size(), 0);
+  size_t k = 0;
+  for(; k < elim.size(); k++) {
+    auto it = column_of.find(elim_keys[k]);
+    // unit columns of vanished linear terms stay independent
+    if(it == column_of.end() && !elim_keys[k].second) {
+      position.push_back(-1);
+      continue;
+    }
+    if(it == column_of.end() || !equal_columns(elim.column(k), columns[it->second]))
+      break;
+    position.push_back(it->second);
+    added[it->second] = 1;
+    reused_kernel_column_count++;
+  }
+  elim.truncate(k);
+  elim_keys.resize(k);
+
+  // unit columns are added first, as they never change
+  for(bool nf : { false, true }) {
+    for(size_t j = 0; j < keys.size(); j++) {
+      if(added[j] || keys[j].second != nf)
+        continue;
+      elim.push_column(columns[j]);
+      elim_keys.push_back(keys[j]);
+      position.push_back(j);
+    }
+  }
+  kernel_column_count += keys.size();
+
+  elim.kernel(position, keys.size(), K);
+}
+
 /*------------------------------------------------------------------------*/
 /*
  * Possible optimizations:
@@ -51,8 +217,9 @@ compress_linear(Polynomial* g, std::map<Var*, size_t>& var_to_id) {
  *   Store normal forms
  */
 static std::vector<compressed_polynomial>
-run_fglm(std::vector<Polynomial*>& normal_forms,
-         std::map<Var*, size_t>& var_to_id) {
+run_fglm(LinearizationContext& ctx, Gate* root, SpeculativeSubcircuit* spec) {
+  std::vector<Polynomial*>& normal_forms = ctx.normal_forms;
+  std::map<Var*, size_t>& var_to_id = ctx.var_to_id;
   count_fglm_call++;
   if(verbose > 2)
     msg("========= running run_fglm =========");
@@ -89,65 +256,110 @@ run_fglm(std::vector<Polynomial*>& normal_forms,
     return cmp_term(t1.first, t2.first) == 1;
   });
 
-  // set up matrix
+  // set up matrix, which only stores the nonzero entries
   size_t n_rows = rows.size();
   size_t n_cols = cols.size();
-  fmpq_mat_t mat;
-  fmpq_mat_init(mat, n_rows, n_cols);
+  SparseMatrix mat(n_rows, n_cols);
   long j = 0;
 
+  // columns of the incremental elimination are identified by their term
+  std::vector<std::pair<size_t, bool>> keys;
+  std::vector<SparseRow> columns;
+
   for(const auto& [t, id] : cols) {
     // those are the linear terms
     if(id < 0) {
-      fmpq_set_si(fmpq_mat_entry(mat, term_to_id[t], j), 1, 1);
+      if(incremental_kernel) {
+        keys.emplace_back(term_row(ctx, t), 0);
+        columns.push_back({ { term_row(ctx, t), Coeff(1) } });
+      } else {
+        mat.push_entry(term_to_id[t], j, 1);
+      }
     }
     // those are the normal forms
     else {
       Polynomial* g = normal_forms[id];
       // we assume that leading coefficient is +- 1
-      assert(mpz_cmpabs_ui(g->get_lm()->coeff, 1) == 0);
-      int sign = mpz_sgn(g->get_lm()->coeff);
+      assert(g->get_lm()->get_coeff().cmp_si(1) == 0 || g->get_lm()->get_coeff().cmp_si(-1) == 0);
+      int sign = g->get_lm()->get_coeff().sgn();
+      SparseRow col;
       for(size_t k = 1; k < g->len(); k++) {
         Monomial* m = g->get_mon(k);
-        size_t i = term_to_id[m->get_term()];
-        mpz_class c(m->coeff);
-        c = sign > 0 ? -c : c;
-        fmpq_set_si(fmpq_mat_entry(mat, i, j), c.get_si(), 1);
+        Coeff c = m->get_coeff();
+        if(sign > 0)
+          c.neg(c);
+        if(incremental_kernel)
+          col.emplace_back(term_row(ctx, m->get_term()), c);
+        else
+          mat.push_entry(term_to_id[m->get_term()], j, c);
+      }
+      if(incremental_kernel) {
+        std::sort(col.begin(), col.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        keys.emplace_back(term_row(ctx, t), 1);
+        columns.push_back(std::move(col));
       }
     }
     j++;
   }
 
-  fmpq_mat_t K;
-  kernel(mat, K);
-  
-  bool is_zero = true;
-  for(long i = 0; i < fmpq_mat_nrows(K); i++)
-    if(!row_is_zero(K,i)) {
-      is_zero = false;
-      break;
+  auto compute_kernel = [&](fmpz_mat_t K) {
+    if(incremental_kernel) {
+      reuse_elimination(ctx, keys, columns, K);
+    } else if(sparse_kernel) {
+      mat.kernel(K);
+    } else {
+      fmpq_mat_t dense;
+      mat.to_dense(dense);
+      integer_kernel(dense, K);
+      fmpq_mat_clear(dense);
     }
+  };
+
+  // the kernel only works on mat, hence the next sub-circuit can be
+  // selected in the meantime
+  fmpz_mat_t K;
+  if(spec && spec->requested) {
+    double pre_overlap_time = process_time();
+    double kernel_time = 0;
+    std::thread worker([&compute_kernel, &K, &kernel_time] {
+      double pre_kernel_time = process_time();
+      compute_kernel(K);
+      kernel_time = process_time() - pre_kernel_time;
+    });
+    select_speculative_subcircuit(ctx, root, *spec);
+    worker.join();
+    // the caller adds the whole overlap to the fglm and matrix time, of
+    // which only the kernel belongs to them, the selection is counted as
+    // getting circuits
+    double overlap_time = process_time() - pre_overlap_time;
+    fglm_time -= overlap_time - kernel_time;
+    matrix_time -= overlap_time - kernel_time;
+  } else {
+    compute_kernel(K);
+  }
+  
   // kernel is zero --> we found no linear polynomials
-  if(is_zero) {
+  if(fmpz_mat_is_zero(K)) {
+    fmpz_mat_clear(K);
     return compressed_res;
   }
 
-  mpz_t tmp;
-  mpz_init(tmp);
   // construct compressed form of linear polynomials
-  compressed_res.reserve(fmpq_mat_nrows(K));
-  indices.clear();
-  for(long i = 0; i < fmpq_mat_nrows(K); i++) {
-    //  check if row contains a denominator -> that would be bad
-    if(!is_denom_free(K,i))
-      continue;
+  compressed_res.reserve(fmpz_mat_nrows(K));
+  ctx.indices.clear();
+  for(long i = 0; i < fmpz_mat_nrows(K); i++) {
     j = 0;
-    while(fmpq_is_zero(fmpq_mat_entry(K,i,j))) j++;
+    while(fmpz_is_zero(fmpz_mat_entry(K,i,j))) j++;
+    // rows are primitive, gates can only be substituted by the linear
+    // polynomial if its leading coefficient is +- 1
+    if(!fmpz_is_pm1(fmpz_mat_entry(K,i,j)))
+      continue;
    
     compressed_polynomial p;
     std::vector<int> indices_p;
-    for(; j < fmpq_mat_ncols(K); j++) {
-      if(fmpq_is_zero(fmpq_mat_entry(K,i,j)))
+    for(; j < fmpz_mat_ncols(K); j++) {
+      if(fmpz_is_zero(fmpz_mat_entry(K,i,j)))
         continue;
       size_t id = 0;
       // constant coefficient gets id = 0
@@ -158,7 +370,7 @@ run_fglm(std::vector<Polynomial*>& normal_forms,
         id = var_to_id[v];
       }
       mpz_class c;
-      fmpq_get_mpz_frac(c.get_mpz_t(), tmp, fmpq_mat_entry(K,i,j));
+      fmpz_get_mpz(c.get_mpz_t(), fmpz_mat_entry(K,i,j));
       p.emplace_back(c, id);
 
       // log coeff * nf = new_poly
@@ -166,10 +378,9 @@ run_fglm(std::vector<Polynomial*>& normal_forms,
       if(proof_logging and cols[j].second >= 0) {
         Polynomial* nf = normal_forms[cols[j].second];
         c = -c;
-        if(static_cast<int>(c.get_si()) != 1) {
+        if(c != 1) {
           Polynomial* pp = multiply_poly_with_constant(nf, c.get_mpz_t());
-          print_pac_mul_const_rule(
-            proof_file, nf, static_cast<int>(c.get_si()), pp);
+          print_pac_mul_const_rule(proof_file, nf, c.get_mpz_t(), pp);
           indices_p.push_back(pp->get_idx());
           delete(pp);
 
@@ -179,21 +390,21 @@ run_fglm(std::vector<Polynomial*>& normal_forms,
       }
     }
     compressed_res.push_back(p);
-    indices.push_back(indices_p);
+    ctx.indices.push_back(indices_p);
   }
+  fmpz_mat_clear(K);
  
   return compressed_res;
 }
 
 /*------------------------------------------------------------------------*/
-std::vector<Polynomial*> linear_polies;
 static void
-construct_linear_polynomials(
-                             std::vector<compressed_polynomial>& compressed,
-                             std::map<Var*, size_t>& var_to_id) {
+construct_linear_polynomials(LinearizationContext& ctx) {
+  const std::vector<compressed_polynomial>& compressed = ctx.cache;
+  std::vector<Polynomial*>& linear_polies = ctx.linear_polies;
   linear_polies.clear();
-  std::vector<Term*> id_to_term(var_to_id.size() + 1);
-  for(auto [var, id] : var_to_id) {
+  std::vector<Term*> id_to_term(ctx.var_to_id.size() + 1);
+  for(auto [var, id] : ctx.var_to_id) {
     Term* t = new_term(var, 0);
     id_to_term[id] = t;
   }
@@ -212,7 +423,9 @@ construct_linear_polynomials(
 }
 
 static bool
-update_gates(Gate* g) {
+update_gates(LinearizationContext& ctx, Gate* g) {
+  const std::vector<Polynomial*>& linear_polies = ctx.linear_polies;
+  std::vector<std::vector<int>>& indices = ctx.indices;
   bool flag = 0;
   
   if(verbose > 2)
@@ -264,37 +477,37 @@ update_gates(Gate* g) {
 }
 
 /*------------------------------------------------------------------------*/
-bool
-cmp_np(const Normalized_poly& p1, const Normalized_poly& p2) {
-  return p1.coeffs == p2.coeffs and p1.terms == p2.terms;
-}
+std::map<size_t, std::vector<Polynomial*>> used_van_mon;
 
-auto circuit_cmp = [](const std::vector<Normalized_poly>& c1,
-                      const std::vector<Normalized_poly>& c2) -> bool {
-  if(c1.size() != c2.size())
-    return false;
-  for(size_t i = 0; i < c1.size(); i++) {
-    if(c1[i].coeffs != c2[i].coeffs or c1[i].terms != c2[i].terms)
-      return false;
-  }
-  return true;
-};
+// / hashes of the cached sub-circuits without canonical labeling, only
+// / used to count the cache hits that are due to the canonical labeling
+std::unordered_set<size_t> unlabeled_circuits;
 
-std::unordered_map<std::vector<Normalized_poly>,
-                   std::vector<compressed_polynomial>,
-                   circuit_hash,
-                   decltype(circuit_cmp)>
-  cached_circuits;
+/*------------------------------------------------------------------------*/
+// Caches the linear polynomials of the sub-circuit of ctx in memory and in
+// the cache file, if one is used
+static void
+cache_circuit(const LinearizationContext& ctx,
+              const std::vector<compressed_polynomial>& res) {
+  cached_circuits.insert(ctx.circuit, res);
+  store_cached_circuit(ctx, res);
+  unlabeled_circuits.insert(ctx.unlabeled_hash);
+}
 
-std::map<Var*, size_t> var_to_id;
-std::vector<Normalized_poly> circuit;
-std::vector<compressed_polynomial> cache;
-std::vector<Polynomial*> normal_forms;
-std::map<size_t, std::vector<Polynomial*>> used_van_mon;
+/*------------------------------------------------------------------------*/
+// Counts a cache hit, a hit of the memory cache may only be found due to
+// the canonical labeling, a hit of the cache file does not depend on it
+static void
+count_cache_hit(const LinearizationContext& ctx, bool from_file) {
+  circut_cached_count++;
+  if(canonical_labeling && !proof_logging
+     && unlabeled_circuits.insert(ctx.unlabeled_hash).second && !from_file)
+    canonical_cached_count++;
+}
 
 /*------------------------------------------------------------------------*/
 static bool
-linearize_via_msolve(Gate* g) {
+linearize_via_msolve(LinearizationContext& ctx, Gate* g) {
   count_msolve_call++;
 
   std::string vars;
@@ -313,16 +526,16 @@ linearize_via_msolve(Gate* g) {
   if(!f)
     die(2, "cannot open file %s", output.c_str());
 
-  for(const auto& tag : var) {
+  for(const auto& tag : ctx.var) {
     fprintf(f, "%s", tag->get_var_name());
-    if(tag != *var.rbegin())
+    if(tag != *ctx.var.rbegin())
       fprintf(f, ",");
   }
 
   fprintf(f, "\n");
   fprintf(f, "1073741827\n");
 
-  for(const auto& gatep : gate_poly) {
+  for(const auto& gatep : ctx.gate_poly) {
     Polynomial* gpol = gatep->get_gate_constraint();
     Polynomial* tmp = unflip_poly(gpol);
     tmp->print(f, 0);
@@ -330,9 +543,9 @@ linearize_via_msolve(Gate* g) {
     delete(tmp);
   }
 
-  for(const auto& gatep : var) {
+  for(const auto& gatep : ctx.var) {
     fprintf(f, "-%s^2+%s", gatep->get_var_name(), gatep->get_var_name());
-    if(gatep != *var.rbegin())
+    if(gatep != *ctx.var.rbegin())
       fprintf(f, ",\n");
   }
   fclose(f);
@@ -360,11 +573,13 @@ linearize_via_msolve(Gate* g) {
 
 /*------------------------------------------------------------------------*/
 static int
-internal_linearize(Gate* g,
+internal_linearize(LinearizationContext& ctx,
+                            Gate* g,
                             int depth,
                             size_t fanout_size,
                             int init,
-                            bool single_expand) {
+                            bool single_expand,
+                            SpeculativeSubcircuit* spec) {
   // statistics
   total_circuit_lin_count++;
 
@@ -372,24 +587,33 @@ internal_linearize(Gate* g,
 
   bool res = 0;
 
-  var_to_id.clear();
-  circuit.clear();
-  cache.clear();
-  normal_forms.clear();
-
-  // get subcircuit
-  
-  if(!get_and_compress_subcircuit(
-       g, depth, fanout_size, init, single_expand, circuit, var_to_id))
+  ctx.var_to_id.clear();
+  ctx.circuit.clear();
+  ctx.cache.clear();
+  ctx.normal_forms.clear();
+
+  // get subcircuit, which may already have been selected speculatively
+  bool found;
+  LinearizationConfig config{ depth, fanout_size, init, single_expand };
+  if(spec && spec->ready && spec->config == config) {
+    found = spec->found;
+    adopt_speculation(ctx, *spec);
+  } else {
+    if(spec)
+      discard_speculation(*spec);
+    found = get_and_compress_subcircuit(
+      ctx, g, depth, fanout_size, init, single_expand);
+  }
+  if(!found)
     return -1;
  
 
 
   circuit_hash hasher;
-  std::size_t hash_value = hasher(circuit);// Get hash value
+  std::size_t hash_value = hasher(ctx.circuit);// Get hash value
   std::vector<size_t> indices_input_new_pattern;
 
-  for(const auto& gatep : gate_poly) {
+  for(const auto& gatep : ctx.gate_poly) {
     if(gatep->get_nf())
       indices_input_new_pattern.push_back(gatep->get_nf()->get_idx());
   }
@@ -398,44 +622,51 @@ internal_linearize(Gate* g,
   std::vector<Polynomial*> new_nf_poly;
   // check cache
   bool found_cache = false;
-  if(cached_circuits.find(circuit) != cached_circuits.end()) {
+  if(cached_circuits.find(ctx.circuit, ctx.cache)) {
     found_cache = true;
-    cache = cached_circuits[circuit];
 
     if(verbose > 1)
       msg("found a cached circuit at dist %i", g->get_dist());
-    circut_cached_count++;
+    count_cache_hit(ctx, 0);
+
+  } else if(find_cached_circuit(ctx, ctx.cache)) {
+    found_cache = true;
+    cached_circuits.insert(ctx.circuit, ctx.cache);
+
+    if(verbose > 1)
+      msg("found circuit in the cache file at dist %i", g->get_dist());
+    count_cache_hit(ctx, 1);
 
   } else if(!msolve) {
     
   
     if(is_internal_fsa(g) && !force_fglm) {   
       double pre_gap_time = process_time(); 
-      linear_polies = guess_linear();
+      ctx.linear_polies = guess_linear(ctx);
 
-      if(linear_polies.size() == 0) {
+      if(ctx.linear_polies.size() == 0) {
         unmark_fsa();
-        gate_poly.clear();
-        sc_inputs.clear();
-        var.clear();
+        ctx.gate_poly.clear();
+        ctx.sc_inputs.clear();
+        ctx.var.clear();
       }
       
       
       gap_time += (process_time() - pre_gap_time);
       linearization_time += process_time() - call_init_time;
-      return update_gates(g);
+      return update_gates(ctx, g);
     } else if (force_guessing) {
       double pre_gap_time = process_time(); 
-      linear_polies = guess_linear();
+      ctx.linear_polies = guess_linear(ctx);
       gap_time += (process_time() - pre_gap_time);
       std::vector<compressed_polynomial> cache;
-      for(auto& poly: linear_polies){
-        cache.push_back(compress_linear(poly, var_to_id));
+      for(auto& poly: ctx.linear_polies){
+        cache.push_back(compress_linear(poly, ctx.var_to_id));
       }
 
-      if(do_caching) cached_circuits[circuit] = cache;
+      if(do_caching) cache_circuit(ctx, cache);
       linearization_time += (process_time() - call_init_time);
-      return update_gates(g);
+      return update_gates(ctx, g);
    
     } else {
       double pre_fglm_time = process_time(); 
@@ -447,11 +678,11 @@ internal_linearize(Gate* g,
       if(proof_logging && do_caching) {
         fprintf(proof_file, "pattern_new %lu {\n", hash_value);
 
-        for(auto& v : var_to_id) {
+        for(auto& v : ctx.var_to_id) {
           v.first->set_id(v.second);
         }
 
-        for(const auto& gatep : gate_poly) {
+        for(const auto& gatep : ctx.gate_poly) {
           fprintf(proof_file, "in%i %lu ", i++, gatep->get_nf()->get_idx());
 
           gatep->print_nf(proof_file);
@@ -460,7 +691,7 @@ internal_linearize(Gate* g,
 
 
       double pre_nf_time = process_time();
-      normal_forms = compute_normalforms(&used_van_poly, &new_nf_poly);
+      ctx.normal_forms = compute_normalforms(ctx, &used_van_poly, &new_nf_poly);
       nf_time += (process_time() - pre_nf_time);
 
       if(proof_logging && do_caching) {
@@ -470,7 +701,7 @@ internal_linearize(Gate* g,
     
       
 
-      assert(normal_forms.size() > 0);
+      assert(ctx.normal_forms.size() > 0);
 
       // exit if linearisation was found during normal form computation
       if(g->get_gate_constraint()->degree() == 1) {
@@ -481,37 +712,37 @@ internal_linearize(Gate* g,
       } else {
         // run fglm
         double pre_matrix_time = process_time();
-        cache = run_fglm(normal_forms, var_to_id);
+        ctx.cache = run_fglm(ctx, g, spec);
         matrix_time += (process_time() - pre_matrix_time);
 
         // cache result
         if(do_caching)
-          cached_circuits[circuit] = cache;
+          cache_circuit(ctx, ctx.cache);
       }
       fglm_time += (process_time() - pre_fglm_time);
     }
   } else {
-    res = linearize_via_msolve(g);
+    res = linearize_via_msolve(ctx, g);
     if(res) {
       compressed_polynomial g_compr
-        = compress_linear(g->get_gate_constraint(), var_to_id);
-      cache.push_back(g_compr);
-      cached_circuits[circuit] = cache;
+        = compress_linear(g->get_gate_constraint(), ctx.var_to_id);
+      ctx.cache.push_back(g_compr);
+      cache_circuit(ctx, ctx.cache);
     }
     linearization_time += (process_time() - call_init_time);
     return res;
   }
 
   // construct polynomials
-  construct_linear_polynomials(cache, var_to_id);
+  construct_linear_polynomials(ctx);
 
-  res = update_gates(g);
+  res = update_gates(ctx, g);
 
 
   if(proof_logging && do_caching) {
     if(!found_cache) {
       int i = 0;
-      for(auto& p : linear_polies) {
+      for(auto& p : ctx.linear_polies) {
         fprintf(proof_file, "out%i %lu;\n", i++, p->get_idx());
       }
       for(auto& p : new_nf_poly) {
@@ -521,13 +752,13 @@ internal_linearize(Gate* g,
     }
    
 
-    for(auto& v : var_to_id) {
+    for(auto& v : ctx.var_to_id) {
       v.first->set_id(0);
     }
 
 
     fprintf(proof_file, "pattern_apply %lu {\n", hash_value);
-    for(auto& v : var_to_id) {
+    for(auto& v : ctx.var_to_id) {
       fprintf(proof_file, "v%lu  %s;\n", v.second, v.first->get_name());
     }
 
@@ -544,7 +775,7 @@ internal_linearize(Gate* g,
       fprintf(proof_file, "in%i %lu;\n", i++, gatep->get_idx());
     }
 
-    int j = print_pac_pattern_out_rules(proof_file, linear_polies, 0);
+    int j = print_pac_pattern_out_rules(proof_file, ctx.linear_polies, 0);
 
     print_pac_pattern_out_rules(proof_file, new_nf_poly, j);
 
@@ -556,8 +787,8 @@ clean_up:
 
 
   if(res) {
-    for(size_t i = 0; i < normal_forms.size(); i++) {
-      Gate* tmp = gate(normal_forms[i]->get_lt()->get_var_num());
+    for(size_t i = 0; i < ctx.normal_forms.size(); i++) {
+      Gate* tmp = gate(ctx.normal_forms[i]->get_lt()->get_var_num());
       delete(tmp->get_nf());
       tmp->set_nf(0);
     }
@@ -566,6 +797,20 @@ clean_up:
   return res;
 }
 
+/*------------------------------------------------------------------------*/
+// Requests the single expansion that follows a failed attempt
+static void
+request_speculation(SpeculativeSubcircuit* spec,
+                    bool requested,
+                    int depth,
+                    size_t fanout_size,
+                    int init) {
+  if(!spec)
+    return;
+  spec->requested = requested;
+  spec->config = { depth, fanout_size, init, 1 };
+}
+
 /*------------------------------------------------------------------------*/
 // Function from outside
 bool
@@ -574,28 +819,43 @@ linearize_via_fglm_or_gap(Gate* g) {
   int max_depth = g->get_dist();
   int depth = sc_depth;
   size_t fanout_size = sc_fanout;
-  fanout_size_last_call = 0;
+  LinearizationContext ctx;
+
+  // speculative polynomials would shift the indices of the proof
+  SpeculativeSubcircuit speculation;
+  SpeculativeSubcircuit* spec
+    = speculative_linearization && !proof_logging ? &speculation : 0;
 
   int count = 1;
-  int res = internal_linearize(g, depth, fanout_size, count++, 0);
+  request_speculation(spec, depth < max_depth && (count + 1) % 15 != 0,
+                      depth, fanout_size, count + 1);
+  int res = internal_linearize(ctx, g, depth, fanout_size, count++, 0, spec);
 
   while(!res && depth < max_depth) {
     circuit_enlarged_count++;
     if(count % 15 == 0) {
-      res = internal_linearize(g, depth, fanout_size_last_call + 1, 1, 0);
+      request_speculation(spec, 0, depth, fanout_size, 1);
+      res = internal_linearize(ctx, g, depth, ctx.fanout_size_last_call + 1, 1, 0, spec);
       count++;
       if(!res) {
-       res = internal_linearize(g, ++depth, fanout_size, 1, 0);
+       request_speculation(spec, 1, depth + 1, fanout_size, count + 1);
+       res = internal_linearize(ctx, g, ++depth, fanout_size, 1, 0, spec);
        count ++;
       }
     }
 
-    if(!res) res = internal_linearize(g, depth, fanout_size, count++, 1);
+    if(!res) {
+      request_speculation(spec, depth < max_depth && (count + 1) % 15 != 0,
+                          depth, fanout_size, count + 1);
+      res = internal_linearize(ctx, g, depth, fanout_size, count++, 1, spec);
+    }
 
 
     if(res == -1 && max_depth <= 6) {
       if(count-2 > max_depth_count)
         max_depth_count = count-2;
+      if(spec)
+        discard_speculation(*spec);
       return 0;
     }
 
@@ -603,6 +863,11 @@ linearize_via_fglm_or_gap(Gate* g) {
   }
   if(count-2 > max_depth_count)
     max_depth_count = count-2;
+  if(spec)
+    discard_speculation(*spec);
+
+  // terms of the subcircuit ideals may have been deallocated
+  compact_terms();
 
   return res;
 }
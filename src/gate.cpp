@@ -715,11 +715,17 @@ void enlarge_gates(int added_size) {
 /*------------------------------------------------------------------------*/
 
 Gate *gate(int lit) {
-  if (lit <= 0)
-    return gates[M - lit - 1];
-  if (lit < 2)
+  if (lit > 0 && lit < 2)
     return 0;
-  return gates[lit / 2 - 1];
+  return gates[gate_index(lit)];
+}
+
+/*------------------------------------------------------------------------*/
+
+unsigned gate_index(int lit) {
+  if (lit <= 0)
+    return M - lit - 1;
+  return lit / 2 - 1;
 }
 
 /*------------------------------------------------------------------------*/
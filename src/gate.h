@@ -549,6 +549,15 @@ void enlarge_gates(int added_size);
 */
 Gate *gate(int lit);
 
+/**
+    Returns the position of the gate with aiger value 'lit' in gates
+
+    @param lit integer, not a constant
+
+    @returns unsigned
+*/
+unsigned gate_index(int lit);
+
 
 
 Polynomial *gen_gate_constraint(unsigned i);
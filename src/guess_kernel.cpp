@@ -0,0 +1,197 @@
+/*------------------------------------------------------------------------*/
+/*! \file guess_kernel.cpp
+    \brief contains the kernel of the sample matrix of guess-and-prove
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#include "guess_kernel.h"
+
+#include <flint/nmod_mat.h>
+#include <flint/ulong_extras.h>
+
+#include "signal_statistics.h"
+/*------------------------------------------------------------------------*/
+
+static inline bool
+get_bit(const uint64_t* row, size_t j) {
+  return (row[j / 64] >> (j % 64)) & 1;
+}
+
+static inline ulong
+sub_mod(ulong a, ulong b, ulong p) {
+  return a >= b ? a - b : a + (p - b);
+}
+
+static inline ulong
+mul_mod(ulong a, ulong b, ulong p) {
+  return (unsigned __int128)a * b % p;
+}
+
+/*------------------------------------------------------------------------*/
+
+ulong
+GuessKernel::prime() {
+  static const ulong p = n_nextprime(UWORD(1) << 62, 0);
+  return p;
+}
+
+/*------------------------------------------------------------------------*/
+
+bool
+GuessKernel::push_sample(const uint64_t* row) {
+  samples.insert(samples.end(), row, row + row_words);
+  const ulong p = prime();
+
+  // every echelon row vanishes on the other pivot columns, hence the
+  // entries of the sample at the pivots are the multipliers of the rows
+  for(size_t j = 0; j < num_cols; j++)
+    work[j] = get_bit(row, j);
+  for(size_t k = 0; k < pivots.size(); k++) {
+    if(!get_bit(row, pivots[k]))
+      continue;
+    const ulong* e = &echelon[k * num_cols];
+    for(size_t j = pivots[k]; j < num_cols; j++)
+      work[j] = sub_mod(work[j], e[j], p);
+  }
+
+  size_t c = 0;
+  while(c < num_cols && !work[c])
+    c++;
+  if(c == num_cols)
+    return 0;
+
+  ulong inv = n_invmod(work[c], p);
+  for(size_t j = c; j < num_cols; j++)
+    work[j] = mul_mod(work[j], inv, p);
+
+  // keep the form reduced
+  for(size_t k = 0; k < pivots.size(); k++) {
+    ulong* e = &echelon[k * num_cols];
+    ulong f = e[c];
+    if(!f)
+      continue;
+    for(size_t j = c; j < num_cols; j++)
+      if(work[j])
+        e[j] = sub_mod(e[j], mul_mod(f, work[j], p), p);
+  }
+
+  echelon.insert(echelon.end(), work.begin(), work.end());
+  pivots.push_back(c);
+  is_pivot[c] = 1;
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+bool
+GuessKernel::lift(fmpz_mat_t K) const {
+  const ulong p = prime();
+  long dim = num_cols - rank();
+
+  // like kernel() of matrix.h, every free column yields a kernel vector
+  nmod_mat_t B;
+  nmod_mat_init(B, dim, num_cols, p);
+  long r = 0;
+  for(size_t j = 0; j < num_cols; j++) {
+    if(is_pivot[j])
+      continue;
+    nmod_mat_set_entry(B, r, j, p - 1);
+    for(size_t k = 0; k < pivots.size(); k++)
+      nmod_mat_set_entry(B, r, pivots[k], echelon[k * num_cols + j]);
+    r++;
+  }
+  nmod_mat_rref(B);
+
+  fmpq_mat_t Q;
+  fmpq_mat_init(Q, dim, num_cols);
+  fmpz_t mod, res;
+  fmpz_init(mod);
+  fmpz_init(res);
+  fmpz_set_ui(mod, p);
+  bool ok = 1;
+  for(long i = 0; ok && i < dim; i++) {
+    for(size_t j = 0; ok && j < num_cols; j++) {
+      ulong e = nmod_mat_entry(B, i, j);
+      if(!e)
+        continue;
+      fmpz_set_ui(res, p - e);
+      ok = fmpq_reconstruct_fmpz(fmpq_mat_entry(Q, i, j), res, mod);
+    }
+  }
+  if(ok)
+    integer_rows(Q, K);
+
+  fmpz_clear(mod);
+  fmpz_clear(res);
+  fmpq_mat_clear(Q);
+  nmod_mat_clear(B);
+  return ok;
+}
+
+/*------------------------------------------------------------------------*/
+
+bool
+GuessKernel::annihilates(const fmpz_mat_t K) const {
+  long rows = fmpz_mat_nrows(K);
+
+  bool fits = 1;
+  for(long i = 0; fits && i < rows; i++)
+    for(size_t j = 0; fits && j < num_cols; j++)
+      fits = fmpz_fits_si(fmpz_mat_entry(K, i, j));
+  std::vector<slong> small;
+  if(fits)
+    for(long i = 0; i < rows; i++)
+      for(size_t j = 0; j < num_cols; j++)
+        small.push_back(fmpz_get_si(fmpz_mat_entry(K, i, j)));
+
+  fmpz_t sum;
+  fmpz_init(sum);
+  bool res = 1;
+  for(size_t s = 0; res && s < nsamples(); s++) {
+    const uint64_t* row = &samples[s * row_words];
+    for(long i = 0; res && i < rows; i++) {
+      __int128 acc = 0;
+      if(!fits)
+        fmpz_zero(sum);
+      for(size_t w = 0; w < row_words; w++) {
+        for(uint64_t bits = row[w]; bits; bits &= bits - 1) {
+          size_t j = 64 * w + __builtin_ctzll(bits);
+          if(fits)
+            acc += small[i * num_cols + j];
+          else
+            fmpz_add(sum, sum, fmpz_mat_entry(K, i, j));
+        }
+      }
+      res = fits ? !acc : fmpz_is_zero(sum);
+    }
+  }
+  fmpz_clear(sum);
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+GuessKernel::kernel(fmpz_mat_t K) const {
+  // a wrong lift would let a refuted guess reappear, since its
+  // counter example might not increase the rank modulo the prime
+  if(lift(K)) {
+    if(annihilates(K)) {
+      lifted_guess_kernel_count++;
+      return;
+    }
+    fmpz_mat_clear(K);
+  }
+
+  rational_guess_kernel_count++;
+  fmpq_mat_t M;
+  fmpq_mat_init(M, nsamples(), num_cols);
+  for(size_t s = 0; s < nsamples(); s++)
+    for(size_t j = 0; j < num_cols; j++)
+      if(get_bit(&samples[s * row_words], j))
+        fmpq_set_si(fmpq_mat_entry(M, s, j), 1, 1);
+  integer_kernel(M, K);
+  fmpq_mat_clear(M);
+}
@@ -0,0 +1,136 @@
+/*------------------------------------------------------------------------*/
+/*! \file guess_kernel.h
+    \brief contains the kernel of the sample matrix of guess-and-prove
+
+  The sample matrix of guess-and-prove only contains 0/1 entries. Samples
+  are hence stored as packed bit rows, and the reduced row echelon form is
+  maintained modulo a word-size prime while the samples stream in. Since
+  an echelon row is only added for samples that increase the rank, sampling
+  can stop once the rank is stable. The kernel is lifted to the integers
+  when it is needed, the rational elimination of matrix.h is only used if
+  the lift fails.
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#ifndef TALISMAN_SRC_GUESS_KERNEL_H_
+#define TALISMAN_SRC_GUESS_KERNEL_H_
+/*------------------------------------------------------------------------*/
+#include <cstdint>
+#include <vector>
+
+#include "matrix.h"
+/*------------------------------------------------------------------------*/
+
+/** \class GuessKernel
+    Kernel of a 0/1 matrix whose rows are added one at a time. The last
+    column belongs to the constant term.
+*/
+class GuessKernel {
+  // / number of columns
+  size_t num_cols;
+
+  // / words of a packed sample
+  size_t row_words;
+
+  // / added samples, row_words words each
+  std::vector<uint64_t> samples;
+
+  // / reduced row echelon form modulo prime(), num_cols entries per row
+  std::vector<ulong> echelon;
+
+  // / pivot column of each row of echelon
+  std::vector<size_t> pivots;
+
+  // / whether a column is a pivot column
+  std::vector<bool> is_pivot;
+
+  // / row that is reduced by push_sample()
+  std::vector<ulong> work;
+
+  /** Lifts the kernel modulo prime() by rational reconstruction
+
+      @param K initialized fmpz_mat_t
+
+      @return false if an entry cannot be reconstructed
+  */
+  bool lift(fmpz_mat_t K) const;
+
+  /** Checks whether every sample lies in the kernel of the rows of K
+
+      @param K fmpz_mat_t
+
+      @return bool
+  */
+  bool annihilates(const fmpz_mat_t K) const;
+
+  public:
+  /** Constructor
+
+      @param cols number of columns
+  */
+  explicit GuessKernel(size_t cols)
+    : num_cols(cols)
+    , row_words((cols + 63) / 64)
+    , is_pivot(cols, 0)
+    , work(cols) {}
+
+  /** Returns the prime of the elimination
+
+      @return ulong
+  */
+  static ulong prime();
+
+  /** Sets column j of a packed sample
+
+      @param row packed sample
+      @param j column
+  */
+  static void set_bit(uint64_t* row, size_t j) {
+    row[j / 64] |= 1ull << (j % 64);
+  }
+
+  /** Getter for the number of columns
+
+      @return size_t
+  */
+  size_t ncols() const { return num_cols; }
+
+  /** Getter for the words of a packed sample
+
+      @return size_t
+  */
+  size_t words() const { return row_words; }
+
+  /** Getter for the number of added samples
+
+      @return size_t
+  */
+  size_t nsamples() const { return samples.size() / row_words; }
+
+  /** Getter for the rank of the added samples modulo prime()
+
+      @return size_t
+  */
+  size_t rank() const { return pivots.size(); }
+
+  /** Adds a sample and reduces it against the echelon form
+
+      @param row packed sample of words() words
+
+      @return true if the sample increased the rank
+  */
+  bool push_sample(const uint64_t* row);
+
+  /** Computes the kernel in the same form as integer_kernel() of matrix.h,
+      i.e., K is initialized and contains the negated reduced row echelon
+      form of a kernel basis, with every row scaled to a primitive integer
+      vector.
+
+      @param K fmpz_mat_t
+  */
+  void kernel(fmpz_mat_t K) const;
+};
+
+#endif// TALISMAN_SRC_GUESS_KERNEL_H_
@@ -52,3 +52,24 @@ uint64_t hash_string(const std::string &str)
     }
     return res;
 }
+
+/*------------------------------------------------------------------------*/
+
+uint64_t hash_combine(uint64_t seed, uint64_t val)
+{
+    uint64_t res = seed ^ (val + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+    res ^= res >> 33;
+    res *= 0xff51afd7ed558ccdull;
+    res ^= res >> 33;
+    return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+uint64_t hash_mpz(uint64_t seed, mpz_srcptr z)
+{
+    uint64_t res = hash_combine(seed, mpz_sgn(z));
+    for (size_t i = 0; i < mpz_size(z); i++)
+        res = hash_combine(res, mpz_getlimbn(z, i));
+    return res;
+}
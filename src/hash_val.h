@@ -10,6 +10,7 @@
 #define TALISMAN_SRC_HASH_VAL_H_
 /*------------------------------------------------------------------------*/
 #include <assert.h>
+#include <gmp.h>
 
 #include <string>
 #include <cstdint>
@@ -38,4 +39,24 @@ uint64_t get_nonces_entry(size_t index);
 */
 uint64_t hash_string(const std::string &str);
 
+/**
+    Combines a hash value with a further 64-bit value
+
+    @param seed uint64_t hash value
+    @param val uint64_t
+
+    @return a uint64_t hash value
+*/
+uint64_t hash_combine(uint64_t seed, uint64_t val);
+
+/**
+    Combines a hash value with an integer, directly using its limbs
+
+    @param seed uint64_t hash value
+    @param z mpz_srcptr
+
+    @return a uint64_t hash value
+*/
+uint64_t hash_mpz(uint64_t seed, mpz_srcptr z);
+
 #endif // TALISMAN_SRC_HASH_VAL_H_
@@ -0,0 +1,173 @@
+/*------------------------------------------------------------------------*/
+/*! \file linear_remainder.cpp
+    \brief contains a dense representation of linear remainders
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#include "linear_remainder.h"
+
+#include <algorithm>
+#include <climits>
+/*------------------------------------------------------------------------*/
+
+template<class Ring>
+LinearRemainder<Ring>::LinearRemainder(const Polynomial* p, unsigned exp)
+  : ring(exp) {
+  int min_level = INT_MAX, max_level = INT_MIN;
+  for(unsigned i = 0; i < num_gates; i++) {
+    Var* v = gates[i]->get_var();
+    min_level = std::min(min_level, std::min(v->get_level(), v->get_dual()->get_level()));
+    max_level = std::max(max_level, std::max(v->get_level(), v->get_dual()->get_level()));
+  }
+  offset = min_level;
+  size_t n = max_level - min_level + 1;
+  coeff.resize(n);
+  vars.resize(n, 0);
+  queued.resize(n, 0);
+
+  for(unsigned i = 0; i < num_gates; i++) {
+    add_var(gates[i]->get_var());
+    add_var(gates[i]->get_var()->get_dual());
+  }
+
+  for(size_t i = 0; i < p->len(); i++) {
+    Monomial* m = p->get_mon(i);
+    Term* t = m->get_term();
+    if(!t) {
+      ring.add(constant, m->get_coeff());
+      continue;
+    }
+    assert(t->degree() == 1);
+    int idx = t->get_var_level() - offset;
+    ring.add(coeff[idx], m->get_coeff());
+    touch(idx);
+  }
+  touched.clear();
+}
+
+/*------------------------------------------------------------------------*/
+
+template<class Ring>
+void
+LinearRemainder<Ring>::add_var(Var* v) {
+  int idx = v->get_level() - offset;
+  assert(!vars[idx] || vars[idx] == v);
+  vars[idx] = v;
+}
+
+/*------------------------------------------------------------------------*/
+
+template<class Ring>
+void
+LinearRemainder<Ring>::touch(int idx) {
+  touched.push_back(idx);
+  if(queued[idx])
+    return;
+  queued[idx] = 1;
+  heap.push_back(idx);
+  std::push_heap(heap.begin(), heap.end());
+}
+
+/*------------------------------------------------------------------------*/
+
+template<class Ring>
+Var*
+LinearRemainder<Ring>::get_lv() {
+  while(!heap.empty()) {
+    int idx = heap.front();
+    if(!ring.is_zero(coeff[idx]))
+      return vars[idx];
+    std::pop_heap(heap.begin(), heap.end());
+    heap.pop_back();
+    queued[idx] = 0;
+  }
+  return 0;
+}
+
+/*------------------------------------------------------------------------*/
+
+template<class Ring>
+bool
+LinearRemainder<Ring>::is_zero() {
+  return !get_lv() && ring.is_zero(constant);
+}
+
+/*------------------------------------------------------------------------*/
+
+template<class Ring>
+bool
+LinearRemainder<Ring>::substitute(const Polynomial* p) {
+  assert(p->degree() == 1);
+  Monomial* lm = p->get_lm();
+  int lt_idx = p->get_lt()->get_var_level() - offset;
+  const value& c = coeff[lt_idx];
+  if(ring.is_zero(c))
+    return false;
+
+  if(!ring.neg_quotient(quot, c, lm->get_coeff()))
+    die(1, "cannot use p2 to reduce p1");
+
+  touched.clear();
+  for(size_t i = 0; i < p->len(); i++) {
+    Monomial* m = p->get_mon(i);
+    Term* t = m->get_term();
+    if(!t) {
+      ring.addmul(constant, quot, m->get_coeff());
+      ring.reduce(constant);
+      continue;
+    }
+    int idx = t->get_var_level() - offset;
+    ring.addmul(coeff[idx], quot, m->get_coeff());
+    touch(idx);
+  }
+
+  for(int idx : touched)
+    ring.reduce(coeff[idx]);
+  touched.clear();
+  return true;
+}
+
+/*------------------------------------------------------------------------*/
+
+template<class Ring>
+void
+LinearRemainder<Ring>::mod() {
+  for(int idx : heap)
+    ring.reduce(coeff[idx]);
+  ring.reduce(constant);
+}
+
+/*------------------------------------------------------------------------*/
+
+template<class Ring>
+Polynomial*
+LinearRemainder<Ring>::to_poly() {
+  std::vector<int> live;
+  for(int idx : heap)
+    if(!ring.is_zero(coeff[idx]))
+      live.push_back(idx);
+  std::sort(live.begin(), live.end(), std::greater<int>());
+
+  Coeff c;
+  for(int idx : live) {
+    ring.store(c, coeff[idx]);
+    push_mstack_end(new Monomial(c, new_term(vars[idx])));
+  }
+  if(!ring.is_zero(constant)) {
+    ring.store(c, constant);
+    push_mstack_end(new Monomial(c, 0));
+  }
+
+  return build_poly();
+}
+
+/*------------------------------------------------------------------------*/
+
+template class LinearRemainder<GmpRing>;
+template class LinearRemainder<WordRing<uint64_t>>;
+template class LinearRemainder<WordRing<uint128_t>>;
+template class LinearRemainder<LimbRing<4>>;
+template class LinearRemainder<LimbRing<8>>;
+template class LinearRemainder<LimbRing<16>>;
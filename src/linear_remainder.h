@@ -0,0 +1,116 @@
+/*------------------------------------------------------------------------*/
+/*! \file linear_remainder.h
+    \brief contains a dense representation of linear remainders
+
+  The remainder of the linear reduction is kept in a coefficient vector
+  indexed by variable level, together with a max-heap of the levels that
+  are currently in use. Substituting a linear gate constraint therefore
+  only touches the monomials of that constraint. The coefficients are
+  stored in one of the rings of coefficient_ring.h.
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#ifndef TALISMAN_SRC_LINEAR_REMAINDER_H_
+#define TALISMAN_SRC_LINEAR_REMAINDER_H_
+/*------------------------------------------------------------------------*/
+#include <vector>
+
+#include "coefficient_ring.h"
+#include "gate.h"
+/*------------------------------------------------------------------------*/
+
+/** \class LinearRemainder
+    Dense accumulator for linear polynomials. Coefficients are stored at
+    position 'level - offset' of the corresponding variable, the constant
+    coefficient is stored separately. Ring is one of GmpRing, WordRing or
+    LimbRing.
+*/
+template<class Ring>
+class LinearRemainder {
+  typedef typename Ring::value value;
+
+  // / coefficient ring modulo 2^exp
+  Ring ring;
+
+  // / level of the variable stored at index 0
+  int offset = 0;
+
+  // / coefficients indexed by level - offset
+  std::vector<value> coeff;
+
+  // / variable stored at each index
+  std::vector<Var*> vars;
+
+  // / true if index is contained in heap
+  std::vector<bool> queued;
+
+  // / max-heap of indices that may have a nonzero coefficient
+  std::vector<int> heap;
+
+  // / indices changed by the last substitution
+  std::vector<int> touched;
+
+  // / constant coefficient
+  value constant{};
+
+  // / negated quotient used in substitutions
+  value quot{};
+
+  void add_var(Var* v);
+  void touch(int idx);
+
+  public:
+  /** Constructor, allocates coefficients for all variables of gates
+
+      @param p linear Polynomial*
+      @param exp exponent of the modulus
+  */
+  LinearRemainder(const Polynomial* p, unsigned exp);
+
+  /** Returns the name of the coefficient ring
+
+      @return const char*
+  */
+  const char* get_ring_name() const { return ring.name(); }
+
+  /** Returns the leading variable, i.e., the variable with largest level
+      and nonzero coefficient
+
+      @return Var* or 0 if the remainder is constant
+  */
+  Var* get_lv();
+
+  /** Returns whether the remainder is the zero polynomial
+
+      @return bool
+  */
+  bool is_zero();
+
+  /**
+      Substitutes the leading term of the linear polynomial p, i.e., the
+      remainder is reduced to rem - (c/lc(p))*p, where c is the coefficient
+      of lt(p) in the remainder. Changed coefficients are taken modulo
+      2^exp.
+
+      @param p linear Polynomial*
+
+      @return false if lt(p) does not occur in the remainder
+  */
+  bool substitute(const Polynomial* p);
+
+  /**
+      Reduces all coefficients modulo 2^exp
+  */
+  void mod();
+
+  /**
+      Generates the corresponding polynomial
+
+      @return Polynomial*, 0 if the remainder is zero
+  */
+  Polynomial* to_poly();
+};
+
+#endif// TALISMAN_SRC_LINEAR_REMAINDER_H_
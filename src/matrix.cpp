@@ -0,0 +1,391 @@
+/*------------------------------------------------------------------------*/
+/*! \file matrix.cpp
+    \brief contains the row reduction of matrices over the rationals and
+    the integers
+
+  The reduced row echelon form is computed modulo several word-size primes
+  and lifted to the rationals by Chinese remaindering and rational
+  reconstruction. A lift is only accepted if every row of the input lies
+  in its row space, otherwise further primes are added. Integer matrices
+  are reduced fraction-free, which keeps the coefficients exact without
+  introducing denominators.
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#include "matrix.h"
+
+#include <algorithm>
+
+#include <flint/nmod_mat.h>
+#include <flint/ulong_extras.h>
+
+#include "signal_statistics.h"
+/*------------------------------------------------------------------------*/
+
+// / number of primes after which we fall back to rational elimination
+static const int max_primes = 32;
+
+/*------------------------------------------------------------------------*/
+// Reduces mat modulo p, fails if p divides a denominator
+static bool
+reduce_mod_prime(nmod_mat_t A, const fmpq_mat_t mat, ulong p) {
+  for(long i = 0; i < fmpq_mat_nrows(mat); i++) {
+    for(long j = 0; j < fmpq_mat_ncols(mat); j++) {
+      const fmpq* q = fmpq_mat_entry(mat, i, j);
+      if(fmpq_is_zero(q))
+        continue;
+      ulong num = fmpz_fdiv_ui(fmpq_numref(q), p);
+      ulong den = fmpz_fdiv_ui(fmpq_denref(q), p);
+      if(!den)
+        return 0;
+      if(den != 1)
+        num = (unsigned __int128)num * n_invmod(den, p) % p;
+      nmod_mat_set_entry(A, i, j, num);
+    }
+  }
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+// Pivot columns of the first rank rows of A, which is in rref
+static std::vector<size_t>
+modular_pivots(const nmod_mat_t A, long rank) {
+  std::vector<size_t> pivots;
+  long j = 0;
+  for(long i = 0; i < rank; i++) {
+    while(!nmod_mat_entry(A, i, j))
+      j++;
+    pivots.push_back(j);
+  }
+  return pivots;
+}
+
+/*------------------------------------------------------------------------*/
+// Unlucky primes decrease the rank or shift pivots to the right
+static bool
+better_pivots(const std::vector<size_t>& a, const std::vector<size_t>& b) {
+  if(a.size() != b.size())
+    return a.size() > b.size();
+  return a < b;
+}
+
+/*------------------------------------------------------------------------*/
+// Reconstructs the non-pivot entries of R from their residues modulo mod
+static bool
+reconstruct(fmpq_mat_t R,
+            const fmpz_mat_t residues,
+            const fmpz_t mod,
+            const std::vector<size_t>& pivots,
+            const std::vector<bool>& is_pivot) {
+  for(size_t k = 0; k < pivots.size(); k++) {
+    fmpq_one(fmpq_mat_entry(R, k, pivots[k]));
+    for(long j = pivots[k] + 1; j < fmpq_mat_ncols(R); j++) {
+      if(is_pivot[j])
+        continue;
+      if(!fmpq_reconstruct_fmpz(
+           fmpq_mat_entry(R, k, j), fmpz_mat_entry(residues, k, j), mod))
+        return 0;
+    }
+  }
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+// Checks whether every row of mat is contained in the row space of R.
+// Since R has the rank of mat modulo a prime, which is a lower bound of
+// its rational rank, R is then the reduced row echelon form of mat.
+static bool
+in_row_space(const fmpq_mat_t mat,
+             const fmpq_mat_t R,
+             const std::vector<size_t>& pivots,
+             const std::vector<bool>& is_pivot) {
+  long cols = fmpq_mat_ncols(mat);
+  size_t rank = pivots.size();
+
+  // scale R to an integer matrix D*R
+  fmpz_t D, tmp, sum, lhs;
+  fmpz_init_set_si(D, 1);
+  fmpz_init(tmp);
+  fmpz_init(sum);
+  fmpz_init(lhs);
+  for(size_t k = 0; k < rank; k++)
+    for(long j = 0; j < cols; j++)
+      fmpz_lcm(D, D, fmpq_mat_entry_den(R, k, j));
+
+  fmpz_mat_t scaled;
+  fmpz_mat_init(scaled, rank, cols);
+  for(size_t k = 0; k < rank; k++) {
+    for(long j = 0; j < cols; j++) {
+      if(fmpq_is_zero(fmpq_mat_entry(R, k, j)))
+        continue;
+      fmpz_divexact(tmp, D, fmpq_mat_entry_den(R, k, j));
+      fmpz_mul(fmpz_mat_entry(scaled, k, j), tmp, fmpq_mat_entry_num(R, k, j));
+    }
+  }
+
+  // row i lies in the row space iff it equals sum_k mat[i][pivot_k] * R[k]
+  fmpz_mat_t row;
+  fmpz_mat_init(row, 1, cols);
+  std::vector<size_t> used;
+  bool res = 1;
+  for(long i = 0; res && i < fmpq_mat_nrows(mat); i++) {
+    fmpz_one(tmp);
+    for(long j = 0; j < cols; j++)
+      fmpz_lcm(tmp, tmp, fmpq_mat_entry_den(mat, i, j));
+    for(long j = 0; j < cols; j++) {
+      fmpz_divexact(lhs, tmp, fmpq_mat_entry_den(mat, i, j));
+      fmpz_mul(fmpz_mat_entry(row, 0, j), lhs, fmpq_mat_entry_num(mat, i, j));
+    }
+
+    used.clear();
+    for(size_t k = 0; k < rank; k++)
+      if(!fmpz_is_zero(fmpz_mat_entry(row, 0, pivots[k])))
+        used.push_back(k);
+
+    for(long j = 0; res && j < cols; j++) {
+      if(is_pivot[j])
+        continue;
+      fmpz_zero(sum);
+      for(const auto& k : used)
+        fmpz_addmul(
+          sum, fmpz_mat_entry(row, 0, pivots[k]), fmpz_mat_entry(scaled, k, j));
+      fmpz_mul(lhs, D, fmpz_mat_entry(row, 0, j));
+      res = fmpz_equal(lhs, sum);
+    }
+  }
+
+  fmpz_mat_clear(row);
+  fmpz_mat_clear(scaled);
+  fmpz_clear(D);
+  fmpz_clear(tmp);
+  fmpz_clear(sum);
+  fmpz_clear(lhs);
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+// Computes the rref of mat modulo primes until the lift verifies
+static bool
+multi_modular_rref(fmpq_mat_t mat, std::vector<size_t>& pivots) {
+  long rows = fmpq_mat_nrows(mat);
+  long cols = fmpq_mat_ncols(mat);
+
+  std::vector<bool> is_pivot(cols, 0);
+  fmpz_mat_t residues;
+  fmpz_mat_init(residues, 0, cols);
+  fmpq_mat_t R;
+  fmpq_mat_init(R, 0, cols);
+  fmpz_t mod;
+  fmpz_init(mod);
+
+  bool found = 0;
+  int used_primes = 0;
+  ulong p = UWORD(1) << 62;
+  for(int n = 0; !found && n < max_primes; n++) {
+    p = n_nextprime(p, 0);
+    nmod_mat_t A;
+    nmod_mat_init(A, rows, cols, p);
+    if(!reduce_mod_prime(A, mat, p)) {
+      nmod_mat_clear(A);
+      continue;
+    }
+
+    long rank = nmod_mat_rref(A);
+    std::vector<size_t> pivots_p = modular_pivots(A, rank);
+
+    if(used_primes && better_pivots(pivots, pivots_p)) {
+      nmod_mat_clear(A);
+      continue;
+    }
+
+    // restart if all previous primes were unlucky
+    if(!used_primes || pivots_p != pivots) {
+      pivots = pivots_p;
+      std::fill(is_pivot.begin(), is_pivot.end(), 0);
+      for(const auto& j : pivots)
+        is_pivot[j] = 1;
+      fmpz_mat_clear(residues);
+      fmpz_mat_init(residues, rank, cols);
+      fmpq_mat_clear(R);
+      fmpq_mat_init(R, rank, cols);
+      fmpz_one(mod);
+      used_primes = 0;
+    }
+
+    for(long k = 0; k < rank; k++) {
+      for(long j = pivots[k] + 1; j < cols; j++) {
+        if(is_pivot[j])
+          continue;
+        fmpz* r = fmpz_mat_entry(residues, k, j);
+        if(used_primes)
+          fmpz_CRT_ui(r, r, mod, nmod_mat_entry(A, k, j), p, 0);
+        else
+          fmpz_set_ui(r, nmod_mat_entry(A, k, j));
+      }
+    }
+    fmpz_mul_ui(mod, mod, p);
+    used_primes++;
+    rref_prime_count++;
+    nmod_mat_clear(A);
+
+    found = reconstruct(R, residues, mod, pivots, is_pivot)
+            && in_row_space(mat, R, pivots, is_pivot);
+  }
+
+  if(found) {
+    for(long i = 0; i < rows; i++)
+      for(long j = 0; j < cols; j++)
+        if(i < fmpq_mat_nrows(R))
+          fmpq_set(fmpq_mat_entry(mat, i, j), fmpq_mat_entry(R, i, j));
+        else
+          fmpq_zero(fmpq_mat_entry(mat, i, j));
+    if(used_primes > max_rref_primes)
+      max_rref_primes = used_primes;
+  }
+
+  fmpz_mat_clear(residues);
+  fmpq_mat_clear(R);
+  fmpz_clear(mod);
+  return found;
+}
+
+/*------------------------------------------------------------------------*/
+
+std::vector<size_t>
+rref(fmpq_mat_t mat) {
+  std::vector<size_t> pivots;
+  if(multi_modular && multi_modular_rref(mat, pivots)) {
+    modular_rref_count++;
+    return pivots;
+  }
+
+  rational_rref_count++;
+  fmpq_mat_rref(mat, mat);
+
+  pivots.clear();
+  for(auto i = 0; i < fmpq_mat_nrows(mat); i++) {
+    bool piv = false;
+    for(auto j = 0; j < fmpq_mat_ncols(mat); j++) {
+      if(!piv && !fmpq_is_zero(fmpq_mat_entry(mat, i, j))) {
+        piv = true;
+        pivots.push_back(static_cast<size_t>(j));
+      }
+    }
+  }
+
+  return pivots;
+}
+
+/*------------------------------------------------------------------------*/
+// Divides row i of A by the gcd of its entries
+static void
+remove_row_content(fmpz_mat_t A, long i, fmpz_t g) {
+  fmpz_zero(g);
+  for(long j = 0; j < fmpz_mat_ncols(A) && !fmpz_is_one(g); j++)
+    fmpz_gcd(g, g, fmpz_mat_entry(A, i, j));
+  if(fmpz_is_zero(g) || fmpz_is_one(g))
+    return;
+  for(long j = 0; j < fmpz_mat_ncols(A); j++)
+    fmpz_divexact(fmpz_mat_entry(A, i, j), fmpz_mat_entry(A, i, j), g);
+}
+
+/*------------------------------------------------------------------------*/
+
+std::vector<size_t>
+rref_fraction_free(fmpz_mat_t A) {
+  long rows = fmpz_mat_nrows(A);
+  long cols = fmpz_mat_ncols(A);
+  std::vector<size_t> pivots;
+
+  fmpz_t g, u, v;
+  fmpz_init(g);
+  fmpz_init(u);
+  fmpz_init(v);
+
+  long r = 0;
+  for(long j = 0; j < cols && r < rows; j++) {
+    // the smallest pivot keeps the multipliers small
+    long p = -1;
+    for(long i = r; i < rows; i++) {
+      const fmpz* a = fmpz_mat_entry(A, i, j);
+      if(!fmpz_is_zero(a)
+         && (p < 0 || fmpz_cmpabs(a, fmpz_mat_entry(A, p, j)) < 0))
+        p = i;
+    }
+    if(p < 0)
+      continue;
+    if(p != r)
+      for(long k = 0; k < cols; k++)
+        fmpz_swap(fmpz_mat_entry(A, p, k), fmpz_mat_entry(A, r, k));
+
+    // row_i = u*row_i - v*row_r, with u*a_ij = v*a_rj
+    for(long i = 0; i < rows; i++) {
+      if(i == r || fmpz_is_zero(fmpz_mat_entry(A, i, j)))
+        continue;
+      fmpz_gcd(g, fmpz_mat_entry(A, r, j), fmpz_mat_entry(A, i, j));
+      fmpz_divexact(u, fmpz_mat_entry(A, r, j), g);
+      fmpz_divexact(v, fmpz_mat_entry(A, i, j), g);
+      for(long k = 0; k < cols; k++) {
+        fmpz* a = fmpz_mat_entry(A, i, k);
+        if(!fmpz_is_one(u))
+          fmpz_mul(a, a, u);
+        fmpz_submul(a, v, fmpz_mat_entry(A, r, k));
+      }
+      remove_row_content(A, i, g);
+    }
+    pivots.push_back(j);
+    r++;
+  }
+
+  for(long i = 0; i < r; i++) {
+    remove_row_content(A, i, g);
+    if(fmpz_sgn(fmpz_mat_entry(A, i, pivots[i])) < 0)
+      for(long k = 0; k < cols; k++)
+        fmpz_neg(fmpz_mat_entry(A, i, k), fmpz_mat_entry(A, i, k));
+  }
+
+  fmpz_clear(g);
+  fmpz_clear(u);
+  fmpz_clear(v);
+  return pivots;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+integer_rows(const fmpq_mat_t Q, fmpz_mat_t K) {
+  long rows = fmpq_mat_nrows(Q);
+  long cols = fmpq_mat_ncols(Q);
+  fmpz_mat_init(K, rows, cols);
+
+  // the leading entry of a row of Q is -1, hence scaling by the common
+  // denominator yields a primitive row
+  fmpz_t den, tmp;
+  fmpz_init(den);
+  fmpz_init(tmp);
+  for(long i = 0; i < rows; i++) {
+    fmpz_one(den);
+    for(long j = 0; j < cols; j++)
+      fmpz_lcm(den, den, fmpq_mat_entry_den(Q, i, j));
+    for(long j = 0; j < cols; j++) {
+      if(fmpq_is_zero(fmpq_mat_entry(Q, i, j)))
+        continue;
+      fmpz_divexact(tmp, den, fmpq_mat_entry_den(Q, i, j));
+      fmpz_mul(fmpz_mat_entry(K, i, j), tmp, fmpq_mat_entry_num(Q, i, j));
+    }
+  }
+  fmpz_clear(den);
+  fmpz_clear(tmp);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+integer_kernel(fmpq_mat_t M, fmpz_mat_t K) {
+  fmpq_mat_t Q;
+  kernel(M, Q);
+  integer_rows(Q, K);
+  fmpq_mat_clear(Q);
+}
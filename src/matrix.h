@@ -16,41 +16,13 @@
 #include <flint/fmpq.h>
 #include <flint/fmpq_mat.h>
 #include <flint/fmpz.h>
+#include <flint/fmpz_mat.h>
 
 #include "gmp.h"
 #include "gmpxx.h"
 
 /*------------------------------------------------------------------------*/
 
-inline bool
-normalize_row(fmpq_mat_t mat, int i) {
-  fmpz_t den;
-  bool res = false;
-  fmpz_init_set_si(den,1);
-  for(long j = 0; j < fmpq_mat_ncols(mat); j++)
-    fmpz_lcm(den, den, fmpq_mat_entry_den(mat, i, j));
-
-  if(fmpz_popcnt(den) == 1) {
-    for(long j = 0; j < fmpq_mat_ncols(mat); j++)
-      fmpq_mul_fmpz(fmpq_mat_entry(mat,i,j), fmpq_mat_entry(mat,i,j), den);
-  }
-  res = true;
-  fmpz_clear(den);
-  return res;
-}  
-
-inline bool
-is_denom_free(fmpq_mat_t mat, int i) {
-  bool res = true;
-  for(long j = 0; j < fmpq_mat_ncols(mat); j++) {
-    if(fmpz_cmp_ui(fmpq_mat_entry_den(mat, i, j), 1) != 0) {
-      res = false;
-      break;
-    }
-  }
-  return res;
-}
-
 inline bool
 row_is_zero(fmpq_mat_t mat, int i) {
   for(long j = 0; j < fmpq_mat_ncols(mat); j++)
@@ -59,24 +31,17 @@ row_is_zero(fmpq_mat_t mat, int i) {
   return true;
 }
 /*------------------------------------------------------------------------*/
-inline std::vector<size_t>
-rref(fmpq_mat_t mat) {
-  
-  fmpq_mat_rref(mat, mat);
-
-  std::vector<size_t> pivots;
-  for(auto i = 0; i < fmpq_mat_nrows(mat); i++) {
-    bool piv = false;
-    for(auto j = 0; j < fmpq_mat_ncols(mat); j++) {
-      if(!piv && !fmpq_is_zero(fmpq_mat_entry(mat, i, j))) {
-        piv = true;
-        pivots.push_back(static_cast<size_t>(j));
-      }
-    }
-  }
+/**
+    Brings mat into reduced row echelon form. The form is computed modulo
+    word-size primes and lifted to the rationals, FLINT's rational
+    elimination is only used if no lift can be verified.
 
-  return pivots;
-}
+    @param mat fmpq_mat_t
+
+    @return pivot columns of the rows of mat
+*/
+std::vector<size_t>
+rref(fmpq_mat_t mat);
 
 /*------------------------------------------------------------------------*/
 inline void
@@ -120,4 +85,40 @@ kernel(fmpq_mat_t M, fmpq_mat_t K) {
   fmpq_mat_neg(K, K);
 }
 
+/*------------------------------------------------------------------------*/
+/**
+    Brings the integer matrix A into fraction-free reduced row echelon
+    form, i.e., pivot columns are zero apart from their pivot row and every
+    nonzero row is primitive with a positive pivot. Up to the scaling of its
+    rows this is the reduced row echelon form over the rationals.
+
+    @param A fmpz_mat_t
+
+    @return pivot columns of the rows of A
+*/
+std::vector<size_t>
+rref_fraction_free(fmpz_mat_t A);
+
+/*------------------------------------------------------------------------*/
+/**
+    Scales every row of Q to a primitive integer vector. The leading entry
+    of every row of Q needs to be -1. K is initialized.
+
+    @param Q fmpq_mat_t
+    @param K fmpz_mat_t
+*/
+void
+integer_rows(const fmpq_mat_t Q, fmpz_mat_t K);
+
+/*------------------------------------------------------------------------*/
+/**
+    Computes the kernel of M like kernel(), but scales every row of the
+    kernel to a primitive integer vector. K is initialized.
+
+    @param M fmpq_mat_t
+    @param K fmpz_mat_t
+*/
+void
+integer_kernel(fmpq_mat_t M, fmpz_mat_t K);
+
 #endif// TALISMAN_SRC_MAT_
@@ -10,15 +10,24 @@
 #include "monomial.h"
 /*------------------------------------------------------------------------*/
 
-Monomial::Monomial(mpz_t _c, Term* _t)
-  : ref(1) {
-  mpz_init_set(coeff, _c);
+Monomial::Monomial(mpz_srcptr _c, Term* _t)
+  : coeff(_c)
+  , ref(1) {
   if(mpz_sgn(_c) == 0)
     term = 0;
   else
     term = _t;
 }
 
+Monomial::Monomial(const Coeff& _c, Term* _t)
+  : coeff(_c)
+  , ref(1) {
+  if(_c.sgn() == 0)
+    term = 0;
+  else
+    term = _t;
+}
+
 /*------------------------------------------------------------------------*/
 
 Monomial*
@@ -38,7 +47,6 @@ Monomial::copy() {
 Monomial::~Monomial() {
   //assert(ref == 0);
 
-  mpz_clear(coeff);
   deallocate_term(term);
 }
 
@@ -46,7 +54,7 @@ Monomial::~Monomial() {
 
 void
 Monomial::print(FILE* file, bool lm) const {
-  int sign = mpz_sgn(coeff);
+  int sign = coeff.sgn();
   if(!sign)
     return;
   else if(!lm && sign > 0)
@@ -56,14 +64,14 @@ Monomial::print(FILE* file, bool lm) const {
     fputc('+', file);
 #endif
   if(term) {
-    if(mpz_cmp_si(coeff, -1) == 0) {
+    if(coeff.cmp_si(-1) == 0) {
 #ifdef HAVEUNLOCKEDIO
       fputc_unlocked('-', file);
 #else
       fputc('-', file);
 #endif
-    } else if(mpz_cmp_si(coeff, 1) != 0) {
-      mpz_out_str(file, 10, coeff);
+    } else if(coeff.cmp_si(1) != 0) {
+      coeff.print(file);
 #ifdef HAVEUNLOCKEDIO
       fputc_unlocked('*', file);
 #else
@@ -72,7 +80,7 @@ Monomial::print(FILE* file, bool lm) const {
     }
     term->print(file);
   } else
-    mpz_out_str(file, 10, coeff);
+    coeff.print(file);
 }
 
 /*------------------------------------------------------------------------*/
@@ -84,9 +92,8 @@ multiply_monomial(const Monomial* m1, const Monomial* m2) {
   assert(m1);
   assert(m2);
 
-  mpz_t coeff;
-  mpz_init(coeff);
-  mpz_mul(coeff, m1->coeff, m2->coeff);
+  Coeff coeff;
+  coeff.mul(m1->get_coeff(), m2->get_coeff());
 
   Term* t;
   if(m1->get_term() && m2->get_term())
@@ -99,8 +106,6 @@ multiply_monomial(const Monomial* m1, const Monomial* m2) {
     t = 0;
 
   Monomial* mon = new Monomial(coeff, t);
-
-  mpz_clear(coeff);
   return mon;
 }
 
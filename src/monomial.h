@@ -12,6 +12,7 @@
 /*------------------------------------------------------------------------*/
 #include <gmp.h>
 
+#include "coefficient.h"
 #include "term.h"
 /*------------------------------------------------------------------------*/
 
@@ -21,6 +22,7 @@
 */
 
 class Monomial {
+  Coeff coeff; // coefficient
   Term* term;  // term
   unsigned ref;// reference counter
 
@@ -28,14 +30,25 @@ class Monomial {
   unsigned dec_ref() { return --ref; }
 
   public:
-  mpz_t coeff;// coefficient
-
   /** Constructor
 
       @param c mpz_t coefficient
       @param t Term*
   */
-  Monomial(mpz_t _c, Term* _t);
+  Monomial(mpz_srcptr _c, Term* _t);
+
+  /** Constructor
+
+      @param c Coeff coefficient
+      @param t Term*
+  */
+  Monomial(const Coeff& _c, Term* _t);
+
+  /** Getter for member coeff
+
+      @return const Coeff&
+  */
+  const Coeff& get_coeff() const { return coeff; }
 
   /** Getter for member term
 
@@ -75,7 +88,7 @@ class Monomial {
 
   int evalute() {
     int res = this->term->evalute();
-    return static_cast<int>(mpz_get_si(coeff)) * res;
+    return static_cast<int>(coeff.get_si()) * res;
   }
 
   friend void deallocate_monomial(Monomial* m);
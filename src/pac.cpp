@@ -248,4 +248,16 @@ void print_pac_mul_const_rule(
 
   p->set_idx(poly_idx++);
 }
+
+/*------------------------------------------------------------------------*/
+void print_pac_mul_const_rule(
+    FILE *file, const Polynomial *p1, const mpz_t n, Polynomial *p) {
+  fprintf(file, "%u %% %lu *(", poly_idx, p1->get_idx());
+  mpz_out_str(file, 10, n);
+  fputs("), ", file);
+
+  p->print(file);
+
+  p->set_idx(poly_idx++);
+}
 /*------------------------------------------------------------------------*/
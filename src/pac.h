@@ -113,6 +113,17 @@ void print_pac_mul_rule(
   void print_pac_mul_const_rule(
     FILE * file, const Polynomial *p1, int n, Polynomial *p);
 
+/**
+    Prints the multiplication rule of pac for a constant of arbitrary size
+
+    @param file output file
+    @param p1   Polynomial*, Factor
+    @param n    mpz_t, Constant
+    @param p    Polynomial*, Conclusion
+*/
+void print_pac_mul_const_rule(
+  FILE * file, const Polynomial *p1, const mpz_t n, Polynomial *p);
+
 void print_pac_extension_rule_for_mon(FILE * file,Gate * g, const Term * t, Polynomial *p);
 
 void print_dual_constraints(FILE * file);
@@ -10,12 +10,37 @@
 /*------------------------------------------------------------------------*/
 
 
+MonomialArray::~MonomialArray() {
+  for(size_t i = 0; i < num_mon; i++)
+    deallocate_monomial(mon[i]);
+  delete[] mon;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+deallocate_monomial_array(MonomialArray* a) {
+  assert(a->ref > 0);
+  if(--a->ref == 0)
+    delete(a);
+}
+
+/*------------------------------------------------------------------------*/
+
 Polynomial::Polynomial() {}
 Polynomial::Polynomial(Monomial** m, size_t len, int d)
-  : mon(m)
+  : array(new MonomialArray(m, len))
+  , mon(m)
   , num_mon(len)
   , deg(d) {}
 
+Polynomial::Polynomial(const Polynomial* p, size_t first, int d)
+  : array(p->array->copy())
+  , mon(p->mon + first)
+  , num_mon(p->num_mon - first)
+  , idx(p->idx)
+  , deg(d) {}
+
 Monomial*
 Polynomial::get_mon(size_t i) const {
   if(i < num_mon)
@@ -28,14 +53,7 @@ Polynomial::get_mon(size_t i) const {
 
 Polynomial*
 Polynomial::copy() {
-
- for (size_t i = 0 ; i < len(); i++) {
-    Monomial * m = get_mon(i);
-    push_mstack_end(m->copy());
-  }
-  Polynomial * out = build_poly();
-  out->set_idx(idx);
-  return out;
+  return new Polynomial(this, 0, deg);
 }
 /*------------------------------------------------------------------------*/
 
@@ -63,12 +81,8 @@ Polynomial::print(FILE* file, bool end) const {
 
 /*------------------------------------------------------------------------*/
 Polynomial::~Polynomial() {
-
-  for(size_t i = 0; i < len(); i++) {
-    Monomial* m = get_mon(i);
-    deallocate_monomial(m);
-  }
-  delete[] mon;
+  if(array)
+    deallocate_monomial_array(array);
 }
 
 /*------------------------------------------------------------------------*/
@@ -89,7 +103,7 @@ Polynomial::is_constant_one_poly() const {
   Monomial* m = get_mon(0);
   if(m->get_term())
     return 0;
-  if(mpz_cmp_si(m->coeff, 1) != 0)
+  if(m->get_coeff().cmp_si(1) != 0)
     return 0;
 
   return 1;
@@ -120,10 +134,18 @@ Polynomial::get_largest_mon() const {
 /*------------------------------------------------------------------------*/
 Polynomial*
 Polynomial::get_tail_poly() const {
+  if(len() < 2)
+    return 0;
+  int d = 0;
   for(size_t i = 1; i < len(); i++) {
-    push_mstack_end(get_mon(i));
+    Term* t = mon[i]->get_term();
+    if(t && (int)t->degree() > d)
+      d = t->degree();
   }
-  return build_poly();
+  Polynomial* res = new Polynomial(this, 1, d);
+  running_idx++;
+  res->set_idx(running_idx);
+  return res;
 }
 
 /*------------------------------------------------------------------------*/
@@ -156,9 +178,9 @@ Polynomial::min_term_size() const {
 
 /*------------------------------------------------------------------------*/
 // Local variables
-static size_t size_mstack;   // /< size of mstack
-static size_t num_mstack = 0;// /< number of elements in mstack
-static Monomial** mstack;    // /< Monomial** used for building poly
+static thread_local size_t size_mstack;   // /< size of mstack
+static thread_local size_t num_mstack = 0;// /< number of elements in mstack
+static thread_local Monomial** mstack;    // /< Monomial** used for building poly
 
 /*------------------------------------------------------------------------*/
 
@@ -196,7 +218,7 @@ push_mstack_end(Monomial* m) {
     enlarge_mstack();
 
   assert(m);
-  if(mpz_sgn(m->coeff) == 0) {
+  if(m->get_coeff().sgn() == 0) {
     deallocate_monomial(m);
     return;
   }
@@ -209,7 +231,7 @@ push_mstack_end(Monomial* m) {
 void
 push_mstack(Monomial* m) {
   assert(m);
-  if(mpz_sgn(m->coeff) == 0) {
+  if(m->get_coeff().sgn() == 0) {
     deallocate_monomial(m);
     return;
   }
@@ -227,18 +249,15 @@ push_mstack(Monomial* m) {
     if(tmp->get_term()) {
       mstack[num_mstack++] = m;
     } else {
-      mpz_t coeff;
-      mpz_init(coeff);
-      mpz_add(coeff, tmp->coeff, m->coeff);
+      Coeff coeff;
+      coeff.add(tmp->get_coeff(), m->get_coeff());
       deallocate_monomial(m);
       deallocate_monomial(tmp);
 
-      if(mpz_sgn(coeff) != 0)
+      if(coeff.sgn() != 0)
         mstack[num_mstack - 1] = new Monomial(coeff, 0);
       else
         --num_mstack;
-
-      mpz_clear(coeff);
     }
   } else {
     assert(num_mstack > 0);
@@ -256,11 +275,10 @@ push_mstack(Monomial* m) {
     }
 
     if(cmp == 0) {
-      mpz_t coeff;
-      mpz_init(coeff);
-      mpz_add(coeff, tmp->coeff, m->coeff);
+      Coeff coeff;
+      coeff.add(tmp->get_coeff(), m->get_coeff());
 
-      if(mpz_sgn(coeff) == 0) {
+      if(coeff.sgn() == 0) {
         for(unsigned j = i; j < num_mstack - 1; j++)
           mstack[j] = mstack[j + 1];
         num_mstack--;
@@ -269,7 +287,6 @@ push_mstack(Monomial* m) {
       }
       deallocate_monomial(m);
       deallocate_monomial(tmp);
-      mpz_clear(coeff);
     } else {
       for(int j = num_mstack; j > i + 1; j--)
         mstack[j] = mstack[j - 1];
@@ -332,7 +349,7 @@ equal_poly(Polynomial* p1, Polynomial* p2) {
   for(size_t i = 0; i < p1->len(); i++) {
     if(p1->get_mon(i)->get_term() != p2->get_mon(i)->get_term())
       return 0;
-    if(mpz_cmp(p1->get_mon(i)->coeff, p2->get_mon(i)->coeff) != 0)
+    if(p1->get_mon(i)->get_coeff().cmp(p2->get_mon(i)->get_coeff()) != 0)
       return 0;
   }
   return 1;
@@ -349,8 +366,6 @@ cmp_poly(Polynomial* p1, Polynomial* p2) {
 
   Monomial* m1 = p1->get_mon(i);
   Monomial* m2 = p2->get_mon(i);
-  mpz_t coeff;
-  mpz_init(coeff);
 
   while(i < p1->len() && i < p2->len()) {
     if(!m1->get_term())
@@ -389,14 +404,13 @@ add_poly(Polynomial* p1, Polynomial* p2) {
 
   Monomial* m1 = p1->get_mon(i);
   Monomial* m2 = p2->get_mon(j);
-  mpz_t coeff;
-  mpz_init(coeff);
+  Coeff coeff;
 
   while(i < p1->len() && j < p2->len()) {
     if(!m1->get_term() || !m2->get_term()) {
       if(!m1->get_term() && !m2->get_term()) {
-        mpz_add(coeff, m1->coeff, m2->coeff);
-        if(mpz_sgn(coeff) != 0) {
+        coeff.add(m1->get_coeff(), m2->get_coeff());
+        if(coeff.sgn() != 0) {
           Monomial* m = new Monomial(coeff, 0);
           push_mstack_end(m);
         }
@@ -418,8 +432,8 @@ add_poly(Polynomial* p1, Polynomial* p2) {
         push_mstack_end(m2->copy());
         m2 = p2->get_mon(++j);
       } else {
-        mpz_add(coeff, m1->coeff, m2->coeff);
-        if(mpz_sgn(coeff) != 0) {
+        coeff.add(m1->get_coeff(), m2->get_coeff());
+        if(coeff.sgn() != 0) {
           Monomial* m = new Monomial(coeff, m1->get_term_copy());
           push_mstack_end(m);
         }
@@ -428,7 +442,6 @@ add_poly(Polynomial* p1, Polynomial* p2) {
       }
     }
   }
-  mpz_clear(coeff);
 
   while(i < p1->len()) {
     push_mstack_end(m1->copy());
@@ -454,6 +467,19 @@ sub_poly(Polynomial* p1, Polynomial* p2) {
 
 /*------------------------------------------------------------------------*/
 
+// Strict order on terms, the constant term is the smallest term
+static bool
+term_greater(const Term* t1, const Term* t2) {
+  return t1 != t2 && cmp_term(t1, t2) == 1;
+}
+
+/*------------------------------------------------------------------------*/
+// Local variables
+static thread_local std::vector<std::pair<Term*, size_t>> mult_products;// /< products of p1*p2
+static thread_local std::vector<std::pair<size_t, size_t>> mult_heap;// /< next product of each row
+
+/*------------------------------------------------------------------------*/
+
 Polynomial*
 multiply_poly(Polynomial* p1, Polynomial* p2) {
   if(!p1 || !p2)
@@ -461,19 +487,83 @@ multiply_poly(Polynomial* p1, Polynomial* p2) {
   assert(p1);
   assert(p2);
 
-  mpz_t coeff;
-  mpz_init(coeff);
+  // Every monomial of p1 defines a row of products with p2. As variables
+  // are idempotent the product of two terms is not monotone, thus each
+  // row is sorted on its own before the rows are merged using a heap.
+  const size_t n = p1->len(), m = p2->len();
+  mult_products.clear();
+  mult_products.reserve(n * m);
+  mult_heap.clear();
 
-  for(size_t i = 0; i < p1->len(); i++) {
-    Monomial* m1 = p1->get_mon(i);
-    for(size_t j = 0; j < p2->len(); j++) {
-      Monomial* m2 = p2->get_mon(j);
+  for(size_t i = 0; i < n; i++) {
+    Term* t1 = p1->get_mon(i)->get_term();
+    for(size_t j = 0; j < m; j++) {
+      Term* t2 = p2->get_mon(j)->get_term();
+      Term* t;
+      if(t1 && t2)
+        t = multiply_term(t1, t2);
+      else if(t2)
+        t = t2->copy();
+      else if(t1)
+        t = t1->copy();
+      else
+        t = 0;
+      mult_products.push_back(std::make_pair(t, j));
+    }
+    std::sort(mult_products.begin() + i * m, mult_products.begin() + (i + 1) * m,
+      [](const std::pair<Term*, size_t>& a, const std::pair<Term*, size_t>& b) {
+        return term_greater(a.first, b.first);
+      });
+    mult_heap.push_back(std::make_pair(i, 0));
+  }
+
+  auto heap_cmp = [m](const std::pair<size_t, size_t>& a,
+                      const std::pair<size_t, size_t>& b) {
+    return term_greater(mult_products[b.first * m + b.second].first,
+                        mult_products[a.first * m + a.second].first);
+  };
+  std::make_heap(mult_heap.begin(), mult_heap.end(), heap_cmp);
+
+  Coeff coeff;
+  Term* current = 0;
+  bool pending = 0;
+
+  while(!mult_heap.empty()) {
+    std::pop_heap(mult_heap.begin(), mult_heap.end(), heap_cmp);
+    size_t i = mult_heap.back().first, k = mult_heap.back().second;
+    std::pair<Term*, size_t>& prod = mult_products[i * m + k];
+
+    if(pending && prod.first != current) {
+      if(coeff.sgn() != 0)
+        push_mstack_end(new Monomial(coeff, current));
+      else
+        deallocate_term(current);
+      coeff.set_si(0);
+      pending = 0;
+    }
+    if(!pending) {
+      current = prod.first;
+      pending = 1;
+    } else {
+      deallocate_term(prod.first);
+    }
+    coeff.addmul(p1->get_mon(i)->get_coeff(), p2->get_mon(prod.second)->get_coeff());
 
-      push_mstack(multiply_monomial(m1, m2));
+    if(++k < m) {
+      mult_heap.back().second = k;
+      std::push_heap(mult_heap.begin(), mult_heap.end(), heap_cmp);
+    } else {
+      mult_heap.pop_back();
     }
   }
+  if(pending) {
+    if(coeff.sgn() != 0)
+      push_mstack_end(new Monomial(coeff, current));
+    else
+      deallocate_term(current);
+  }
+
   Polynomial* p = build_poly();
-  mpz_clear(coeff);
   return p;
 }
 
@@ -481,21 +571,27 @@ multiply_poly(Polynomial* p1, Polynomial* p2) {
 
 Polynomial*
 multiply_poly_with_constant(Polynomial* p1, mpz_t c) {
-  if(mpz_sgn(c) == 0)
+  Coeff factor(c);
+  return multiply_poly_with_constant(p1, factor);
+}
+
+/*------------------------------------------------------------------------*/
+
+Polynomial*
+multiply_poly_with_constant(Polynomial* p1, const Coeff& c) {
+  if(c.sgn() == 0)
     return 0;
-  mpz_t coeff;
-  mpz_init(coeff);
+  Coeff coeff;
 
   for(size_t i = 0; i < p1->len(); i++) {
     Monomial* m = p1->get_mon(i);
-    mpz_mul(coeff, m->coeff, c);
+    coeff.mul(m->get_coeff(), c);
     if(m->get_term())
       push_mstack_end(new Monomial(coeff, m->get_term_copy()));
     else
       push_mstack_end(new Monomial(coeff, 0));
   }
   Polynomial* tmp = build_poly();
-  mpz_clear(coeff);
   return tmp;
 }
 
@@ -513,7 +609,7 @@ multiply_poly_with_term(Polynomial* p1, Term* t) {
       res = t->copy();
 
     }    
-    push_mstack_end(new Monomial(p1->get_mon(i)->coeff, res));
+    push_mstack_end(new Monomial(p1->get_mon(i)->get_coeff(), res));
   }
   Polynomial* tmp = build_poly();
   return tmp;
@@ -526,14 +622,13 @@ multiply_poly_with_monomial(Polynomial* p1, Monomial * m) {
     return p1->copy();
   if(!p1) return 0;
 
-  mpz_t coeff;
-  mpz_init(coeff);
+  Coeff coeff;
 
   for(size_t i = 0; i < p1->len(); i++) {
     Monomial* m1 = p1->get_mon(i);
     Term * t1 = m1->get_term();
     Term* res = multiply_term(t1, m->get_term());
-    mpz_mul(coeff, m->coeff, m1->coeff);
+    coeff.mul(m->get_coeff(), m1->get_coeff());
     if(!t1) {
       res = m->get_term()->copy();
 
@@ -541,7 +636,6 @@ multiply_poly_with_monomial(Polynomial* p1, Monomial * m) {
     push_mstack_end(new Monomial(coeff, res));
   }
   Polynomial* tmp = build_poly();
-  mpz_clear(coeff);
   return tmp;
 }
 
@@ -562,9 +656,9 @@ divide_by_var(Polynomial* p1, const Term* t) {
     if(lm_tmp->get_term()->contains(v)) {
       Term* t_rem = divide_by_var(lm_tmp->get_term(), v);
       if(t_rem) {
-        push_mstack_end(new Monomial(lm_tmp->coeff, t_rem->copy()));
+        push_mstack_end(new Monomial(lm_tmp->get_coeff(), t_rem->copy()));
       } else {
-        push_mstack_end(new Monomial(lm_tmp->coeff, 0));
+        push_mstack_end(new Monomial(lm_tmp->get_coeff(), 0));
         break;
       }
     }
@@ -591,12 +685,130 @@ divide_poly_by_term(Polynomial* p1, const Term* t) {
 
       if(lm_tmp->get_term()->contains_subterm(t)) {
         Term* t_rem = divide_by_term(lm_tmp->get_term(), t);
-        push_mstack_end(new Monomial(lm_tmp->coeff, t_rem));
+        push_mstack_end(new Monomial(lm_tmp->get_coeff(), t_rem));
       }
     }
     return build_poly();
   }
 }
+/*------------------------------------------------------------------------*/
+
+Geobucket::~Geobucket() {
+  for(Polynomial* b : buckets)
+    delete(b);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+Geobucket::add(Polynomial* p) {
+  while(p) {
+    size_t i = 0;
+    for(size_t cap = 4; p->len() > cap; cap <<= 2)
+      i++;
+    if(i >= buckets.size())
+      buckets.resize(i + 1, 0);
+
+    if(!buckets[i]) {
+      buckets[i] = p;
+      return;
+    }
+    Polynomial* sum = add_poly(buckets[i], p);
+    delete(buckets[i]);
+    delete(p);
+    buckets[i] = 0;
+    p = sum;
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+Monomial*
+Geobucket::get_lm() {
+  while(1) {
+    Term* lt = 0;
+    size_t lead = 0, count = 0;
+    for(size_t i = 0; i < buckets.size(); i++) {
+      if(!buckets[i])
+        continue;
+      Term* t = buckets[i]->get_lt();
+      if(!count || term_greater(t, lt)) {
+        lt = t;
+        lead = i;
+        count = 1;
+      } else if(t == lt) {
+        count++;
+      }
+    }
+    if(!count)
+      return 0;
+    if(count == 1)
+      return buckets[lead]->get_lm();
+
+    // several buckets share the leading term, hence we merge them
+    Polynomial* sum = 0;
+    for(size_t i = lead; i < buckets.size(); i++) {
+      if(!buckets[i] || buckets[i]->get_lt() != lt)
+        continue;
+      if(!sum) {
+        sum = buckets[i];
+      } else {
+        Polynomial* tmp = add_poly(sum, buckets[i]);
+        delete(sum);
+        delete(buckets[i]);
+        sum = tmp;
+      }
+      buckets[i] = 0;
+    }
+    add(sum);
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+Polynomial*
+Geobucket::divide_by_term(const Term* t) const {
+  Polynomial* res = 0;
+  for(Polynomial* b : buckets) {
+    if(!b)
+      continue;
+    Polynomial* q = divide_poly_by_term(b, t);
+    if(!q)
+      continue;
+    if(!res) {
+      res = q;
+    } else {
+      Polynomial* tmp = add_poly(res, q);
+      delete(res);
+      delete(q);
+      res = tmp;
+    }
+  }
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+Polynomial*
+Geobucket::normalize() {
+  Polynomial* res = 0;
+  for(Polynomial*& b : buckets) {
+    if(!b)
+      continue;
+    if(!res) {
+      res = b;
+    } else {
+      Polynomial* tmp = add_poly(res, b);
+      delete(res);
+      delete(b);
+      res = tmp;
+    }
+    b = 0;
+  }
+  buckets.clear();
+  return res;
+}
+
 /*------------------------------------------------------------------------*/
 /*------------------------------------------------------------------------*/
 /*------------------------------------------------------------------------*/
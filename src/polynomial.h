@@ -12,28 +12,96 @@
 #include <cstring>
 #include <deque>
 #include <list>
+#include <vector>
 
 #include "monomial.h"
 /*------------------------------------------------------------------------*/
 extern size_t running_idx;
 
+/** \class MonomialArray
+    Sorted array of monomials, which is shared by all copies of a
+    polynomial. The array is never modified after construction, hence
+    copies and tails of a polynomial can refer to the same array.
+*/
+class MonomialArray {
+  // / monomials, owned by the array
+  Monomial** mon;
+
+  // / number of monomials
+  size_t num_mon;
+
+  // / number of polynomials referring to the array
+  unsigned ref = 1;
+
+  public:
+  /** Constructor, takes ownership of m
+
+      @param m Monomial**
+      @param len size_t
+  */
+  MonomialArray(Monomial** m, size_t len)
+    : mon(m)
+    , num_mon(len) {}
+
+  Monomial** get_mon() const { return mon; }
+
+  MonomialArray* copy() {
+    ++ref;
+    return this;
+  }
+
+  /** Destructor, deallocates the monomials */
+  ~MonomialArray();
+
+  friend void deallocate_monomial_array(MonomialArray* a);
+};
+
+/**
+    Decrements the reference counter of a and deletes a if it goes to zero
+
+    @param a MonomialArray*
+*/
+void
+deallocate_monomial_array(MonomialArray* a);
+
+/*------------------------------------------------------------------------*/
+
 /** \class Polynomial
     This class is used to polynomials.
+    The monomials are a contiguous range of a shared MonomialArray, thus
+    copies and tails are generated without touching the monomials.
 */
 class Polynomial {
 
-  Monomial** mon;
+  // / shared monomial array, 0 for the zero polynomial
+  MonomialArray* array = 0;
+
+  // / first monomial of the polynomial in array
+  Monomial** mon = 0;
 
   size_t num_mon = 0;
   size_t idx;
-  int ref = 1;
 
   int deg = 0;
 
+  /** Constructor, generates a polynomial sharing the monomials of p
+
+      @param p const Polynomial*
+      @param first index of the first monomial of p that is used
+      @param d degree
+  */
+  Polynomial(const Polynomial* p, size_t first, int d);
+
   public:
   /** Constructor */
   Polynomial();
 
+  /** Constructor, takes ownership of m
+
+      @param m Monomial**
+      @param len size_t
+      @param d degree
+  */
   Polynomial(Monomial** m, size_t len, int d);
 
   size_t len() const { return num_mon; }
@@ -49,10 +117,19 @@ class Polynomial {
   Term* get_largest_term() const;
   Monomial* get_largest_mon() const;
 
+  /** Returns the polynomial without its leading monomial, which shares
+      the monomials of this polynomial
+
+      @return Polynomial*, 0 if the tail is zero
+  */
   Polynomial* get_tail_poly() const;
 
   Var* contains_dual_var() const;
 
+  /** Copy routine, the copy shares the monomials of this polynomial
+
+      @return Polynomial*
+  */
   Polynomial* copy();
 
 
@@ -190,6 +267,8 @@ multiply_poly(Polynomial* p1, Polynomial* p2);
 */
 Polynomial*
 multiply_poly_with_constant(Polynomial* p1, mpz_t c);
+Polynomial*
+multiply_poly_with_constant(Polynomial* p1, const Coeff& c);
 
 /**
     Multiplies a polynomial p1 with a constant c
@@ -228,6 +307,54 @@ divide_by_var(Polynomial* p1, const Term* t);
 
 /*---------------------------------------------------------------------------*/
 
+/** \class Geobucket
+    Accumulates a sum of polynomials in buckets of geometrically growing
+    length. Bucket i holds at most 4^(i+1) monomials, hence adding a short
+    polynomial to a long sum only merges buckets of similar length and the
+    sum is normalized only once at the end.
+*/
+class Geobucket {
+  // / sorted polynomials, 0 if a bucket is empty
+  std::vector<Polynomial*> buckets;
+
+  public:
+  /** Destructor, deletes all buckets */
+  ~Geobucket();
+
+  /**
+      Adds p to the sum, takes ownership of p
+
+      @param p Polynomial*
+  */
+  void add(Polynomial* p);
+
+  /**
+      Returns the leading monomial of the sum, merges buckets that share
+      the leading term
+
+      @return Monomial*, 0 if the sum is zero
+  */
+  Monomial* get_lm();
+
+  /**
+      Returns the quotient of dividing the sum by a term t
+
+      @param t Term*
+
+      @return Polynomial*, 0 if no monomial is divisible by t
+  */
+  Polynomial* divide_by_term(const Term* t) const;
+
+  /**
+      Returns the sum of all buckets and clears the buckets
+
+      @return Polynomial*, 0 if the sum is zero
+  */
+  Polynomial* normalize();
+};
+
+/*---------------------------------------------------------------------------*/
+
 // / gmp for 1
 extern mpz_t one;
 
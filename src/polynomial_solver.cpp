@@ -50,12 +50,11 @@ static Polynomial *linearize_spec(Polynomial *spec) {
         if (t != inner_t)
           continue;
         Term *lt = sub_gc->get_lt()->copy();
-        Monomial *tmp = new Monomial(m->coeff, lt);
+        Monomial *tmp = new Monomial(m->get_coeff(), lt);
 
         if (proof_logging) {
-          mpz_t neg;
-          mpz_init(neg);
-          mpz_neg(neg, m->coeff);
+          Coeff neg;
+          neg.neg(m->get_coeff());
           Monomial *sub_mon = new Monomial(neg, term_x->copy());
           Monomial **intern_mstack = new Monomial *[1];
           intern_mstack[0] = sub_mon;
@@ -76,12 +75,11 @@ static Polynomial *linearize_spec(Polynomial *spec) {
         enlarged = 1;
       }
       Term *rep_t = extend_var_gates(t);
-      Monomial *tmp = new Monomial(m->coeff, rep_t->copy());
+      Monomial *tmp = new Monomial(m->get_coeff(), rep_t->copy());
 
       if (proof_logging) {
-        mpz_t neg;
-        mpz_init(neg);
-        mpz_neg(neg, m->coeff);
+        Coeff neg;
+        neg.neg(m->get_coeff());
         Monomial *sub_mon = new Monomial(neg, term_x->copy());
 
         Monomial **intern_mstack = new Monomial *[1];
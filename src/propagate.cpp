@@ -45,16 +45,11 @@ static bool try_propagate_constant_one(Polynomial *p)
   assert(p->degree() == 1 && p->len() == 2);
   assert(!p->get_mon(1)->get_term());
 
-  mpz_t neg;
-  mpz_init(neg);
-  mpz_neg(neg, p->get_mon(1)->coeff);
+  Coeff neg;
+  neg.neg(p->get_mon(1)->get_coeff());
 
-  if (mpz_cmp(p->get_lm()->coeff, neg) != 0)
-  {
-    mpz_clear(neg);
+  if (p->get_lm()->get_coeff().cmp(neg) != 0)
     return 0;
-  }
-  mpz_clear(neg);
 
   Gate *g = gate(p->get_lt()->get_var_num());
   if (verbose > 1)
@@ -70,16 +65,11 @@ static bool try_propagate_equality(Polynomial *p)
   // p:= ax-ay for a in int
   assert(p->degree() == 1 && p->len() == 2);
 
-  mpz_t neg;
-  mpz_init(neg);
-  mpz_neg(neg, p->get_mon(1)->coeff);
+  Coeff neg;
+  neg.neg(p->get_mon(1)->get_coeff());
 
-  if (mpz_cmp(p->get_lm()->coeff, neg) != 0)
-  {
-    mpz_clear(neg);
+  if (p->get_lm()->get_coeff().cmp(neg) != 0)
     return 0;
-  }
-  mpz_clear(neg);
 
   Gate *g = gate(p->get_lt()->get_var_num());
   if (verbose > 1)
@@ -97,19 +87,14 @@ static bool try_propagate_negated_equality(Polynomial *p)
   if (p->get_mon(2)->get_term())
     return 0;
 
-  if (mpz_cmp(p->get_lm()->coeff, p->get_mon(1)->coeff) != 0)
+  if (p->get_lm()->get_coeff().cmp(p->get_mon(1)->get_coeff()) != 0)
     return 0;
 
-  mpz_t neg;
-  mpz_init(neg);
-  mpz_neg(neg, p->get_mon(2)->coeff);
+  Coeff neg;
+  neg.neg(p->get_mon(2)->get_coeff());
 
-  if (mpz_cmp(p->get_mon(1)->coeff, neg) != 0)
-  {
-    mpz_clear(neg);
+  if (p->get_mon(1)->get_coeff().cmp(neg) != 0)
     return 0;
-  }
-  mpz_clear(neg);
 
   Gate *g = gate(p->get_lt()->get_var_num());
   if (verbose > 1)
@@ -14,6 +14,7 @@
 #include <algorithm>
 #include <list>
 
+#include "linear_remainder.h"
 #include "propagate.h"
 #include "variable.h"
 /*------------------------------------------------------------------------*/
@@ -21,8 +22,68 @@
 int proof = 0;
 /*------------------------------------------------------------------------*/
 
+/*------------------------------------------------------------------------*/
+// Accumulates the reductions in a geobucket, which is only normalized once
+// the leading term is an input. Needs to be disabled for proof logging,
+// as every intermediate remainder has to be printed.
+static Polynomial *non_linear_bucket_reduction(Polynomial *rem) {
+  Geobucket sum;
+  sum.add(rem);
+
+  Monomial *lm = sum.get_lm();
+  Gate *g = gate(lm->get_term()->get_var_num());
+  while (!g->get_input()) {
+    Polynomial *gc = unflip_poly(g->get_gate_constraint());
+
+    if (verbose >= 2 && gc) {
+      msg_nl("non-linear reducing by ");
+      gc->print(stdout);
+    }
+
+    non_linear_count++;
+    Polynomial *negfactor = sum.divide_by_term(gc->get_lt());
+    if (negfactor) {
+      if (gc->get_lm()->get_coeff().sgn() > 0) {
+        Polynomial *tmp = multiply_poly_with_constant(negfactor, minus_one);
+        delete (negfactor);
+        negfactor = tmp;
+      }
+      sum.add(multiply_poly(negfactor, gc));
+      delete (negfactor);
+    }
+    delete (gc);
+
+    g->set_elim();
+
+    lm = sum.get_lm();
+    if (!lm) {
+      msg("remainder is 0");
+      return 0;
+    }
+
+    if (verbose >= 3) {
+      rem = sum.normalize();
+      msg_nl("remainder is ");
+      rem->print(stdout);
+      msg(" ");
+      sum.add(rem);
+      lm = sum.get_lm();
+    }
+    if (!lm->get_term()) break; // we need to abort when rem is a constant
+    g = gate(lm->get_term()->get_var_num());
+  }
+
+  rem = sum.normalize();
+  Polynomial *mod_tmp = mod_poly(rem, NN);
+  delete (rem);
+  return mod_tmp;
+}
+
 /*------------------------------------------------------------------------*/
 Polynomial *non_linear_reduction(Polynomial *rem) {
+  if (!proof_logging)
+    return non_linear_bucket_reduction(rem);
+
 
   Gate *g = gate(rem->get_lt()->get_var_num());
   while (!g->get_input()) {
@@ -70,6 +131,86 @@ Polynomial *non_linear_reduction(Polynomial *rem) {
   return rem;
 }
 
+/*------------------------------------------------------------------------*/
+// Gates are linearized on demand in the order of the reduction. Linearizing
+// a gate may update the constraints of further gates of its sub-circuit and
+// propagates constants, hence linearizing ahead of the reduction (or in
+// parallel to it) would change later sub-circuits and the cached results.
+static Polynomial *get_linearized_gate_constraint(Gate *g) {
+  if (g->get_gate_constraint()->degree() > 1) {
+    Polynomial *p = remove_vanishing_monomials(g->get_gate_constraint());
+    g->update_gate_poly(p);
+  }
+
+  if (g->get_gate_constraint()->degree() > 1) {
+    Polynomial *p = unflip_poly_and_remove_van_mon(g->get_gate_constraint());
+    g->update_gate_poly(p);
+  }
+
+  if (g->get_gate_constraint()->degree() > 1) {
+    linearize_via_fglm_or_gap(g);
+    if (!g->get_gate_constraint())
+      die(2, "g lost gate constraint");
+    if (verbose >= 3)
+      g->get_gate_constraint()->print(stdout);
+  }
+  return g->get_gate_constraint();
+}
+
+/*------------------------------------------------------------------------*/
+template <class Ring>
+static Polynomial *dense_linear_reduce(Polynomial *spec) {
+  LinearRemainder<Ring> rem(spec, NN);
+  delete (spec);
+  msg("remainder coefficients: %s", rem.get_ring_name());
+
+  bool reduced = 0;
+  Var *lv = rem.get_lv();
+  while (lv && !gate(lv->get_num())->get_input()) {
+    Gate *g = gate(lv->get_num());
+    Polynomial *gc = get_linearized_gate_constraint(g);
+
+    if (gc->degree() > 1) {
+      msg_nl("failed to linearize gate poly: ");
+      gc->print(stdout);
+
+      msg("switching to non-linear rewriting");
+      return non_linear_reduction(rem.to_poly());
+    }
+
+    if (verbose >= 2 && gc) {
+      msg_nl("linear reducing by ");
+      gc->print(stdout);
+    }
+
+    rem.substitute(gc);
+    linear_count++;
+    g->set_elim();
+
+    // coefficients that are not touched by substitutions are reduced once
+    if (!reduced) {
+      rem.mod();
+      reduced = 1;
+    }
+
+    if (rem.is_zero()) {
+      msg("remainder is 0");
+      return 0;
+    }
+
+    if (verbose > 2) {
+      Polynomial *tmp = rem.to_poly();
+      msg_nl("remainder is ");
+      tmp->print(stdout);
+      msg(" ");
+      delete (tmp);
+    }
+    lv = rem.get_lv();
+  }
+
+  return rem.to_poly();
+}
+
 /*------------------------------------------------------------------------*/
 Polynomial *reduce(Polynomial *spec) {
   print_hline();
@@ -82,27 +223,28 @@ Polynomial *reduce(Polynomial *spec) {
     rem->print(stdout);
   }
 
+  // PAC steps are derived from the polynomial substitution
+  if (dense_reduction && !proof_logging) {
+    // truncation modulo 2^NN is free for native coefficients
+    if (!native_coefficients)
+      return dense_linear_reduce<GmpRing>(rem);
+    else if (NN <= 64)
+      return dense_linear_reduce<WordRing<uint64_t>>(rem);
+    else if (NN <= 128)
+      return dense_linear_reduce<WordRing<uint128_t>>(rem);
+    else if (NN <= 256)
+      return dense_linear_reduce<LimbRing<4>>(rem);
+    else if (NN <= 512)
+      return dense_linear_reduce<LimbRing<8>>(rem);
+    else if (NN <= 1024)
+      return dense_linear_reduce<LimbRing<16>>(rem);
+    else
+      return dense_linear_reduce<GmpRing>(rem);
+  }
+
   Gate *g = gate(rem->get_lt()->get_var_num());
   while (!g->get_input()) {
-    if (g->get_gate_constraint()->degree() > 1) {
-      Polynomial *p = remove_vanishing_monomials(g->get_gate_constraint());
-      g->update_gate_poly(p);
-    }
-
-    if (g->get_gate_constraint()->degree() > 1) {
-      Polynomial *p = unflip_poly_and_remove_van_mon(g->get_gate_constraint());
-      g->update_gate_poly(p);
-    }
-
-    if (g->get_gate_constraint()->degree() > 1) {
-      linearize_via_fglm_or_gap(g);
-      if (!g->get_gate_constraint())
-        die(2, "g lost gate constraint");
-      if (verbose >= 3)
-        g->get_gate_constraint()->print(stdout);
-    }
-    Polynomial *gc = g->get_gate_constraint();
-
+    Polynomial *gc = get_linearized_gate_constraint(g);
 
     if (gc->degree() > 1) {
       msg_nl("failed to linearize gate poly: ");
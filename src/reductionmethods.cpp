@@ -20,7 +20,7 @@ reduce_by_one_poly(Polynomial* p1, Polynomial* p2, bool non_lin_rewriting) {
   if (!negfactor || negfactor->is_constant_zero_poly())
     return p1->copy();
 
-  if (mpz_cmp_si(p2->get_lm()->coeff, 0) == 1) {
+  if (p2->get_lm()->get_coeff().sgn() > 0) {
     Polynomial* tmp = multiply_poly_with_constant(negfactor, minus_one);
     delete (negfactor);
     negfactor = tmp;
@@ -79,7 +79,7 @@ substitute_linear_poly(Polynomial* p1, Polynomial* p2) {
 
   Monomial* p2_m = p2->get_mon(0);
 
-  if (!mpz_cmp(p1_m->coeff, p2_m->coeff)) {
+  if (!p1_m->get_coeff().cmp(p2_m->get_coeff())) {
     Polynomial* rem = sub_poly(p1, p2);
 
     if (proof_logging) {
@@ -100,20 +100,19 @@ substitute_linear_poly(Polynomial* p1, Polynomial* p2) {
   }
 
   Polynomial* res = 0;
-  mpz_t coeff;
-  mpz_init(coeff);
-  mpz_tdiv_r(coeff, p1_m->coeff, p2_m->coeff);
-  if (mpz_sgn(coeff) != 0) {
+  Coeff rest;
+  rest.tdiv_r(p1_m->get_coeff(), p2_m->get_coeff());
+  if (rest.sgn() != 0) {
     die(1, "cannot use p2 to reduce p1");
   } else {
-    mpz_tdiv_q(coeff, p1_m->coeff, p2_m->coeff);
-    Polynomial* p2_lift = multiply_poly_with_constant(p2, coeff);
+    Coeff quot;
+    quot.tdiv_q(p1_m->get_coeff(), p2_m->get_coeff());
+    Polynomial* p2_lift = multiply_poly_with_constant(p2, quot);
     res = sub_poly(p1, p2_lift);
 
     if (proof_logging) {
-      mpz_t neg;
-      mpz_init(neg);
-      mpz_neg(neg, coeff);
+      Coeff neg;
+      neg.neg(quot);
       push_mstack(new Monomial(neg, term_x->copy()));
       Polynomial* min_one = build_poly();
       Polynomial* res_x_tmp = multiply_poly_with_term(res, term_x);
@@ -127,7 +126,6 @@ substitute_linear_poly(Polynomial* p1, Polynomial* p2) {
 
     delete (p2_lift);
   }
-  mpz_clear(coeff);
   return res;
 }
 /*------------------------------------------------------------------------*/
@@ -163,13 +161,11 @@ flip_var_in_poly(Polynomial* p1, Var* v, bool rem_van) {
         }
         if (!flag) {
           Term* vt = multiply_term_by_var(t, v->get_dual());
-          mpz_t neg;
-          mpz_init(neg);
-          mpz_neg(neg, m->coeff);
+          Coeff neg;
+          neg.neg(m->get_coeff());
           push_mstack(new Monomial(neg, vt));
-          mpz_clear(neg);
         }
-        push_mstack(new Monomial(m->coeff, t));
+        push_mstack(new Monomial(m->get_coeff(), t));
 
       } else {
         push_mstack(m->copy());
@@ -223,13 +219,12 @@ mod_poly(Polynomial* p1, int exp) {
   if (!p1)
     return 0;
 
-  mpz_t coeff;
-  mpz_init(coeff);
+  Coeff coeff;
 
   for (size_t i = 0; i < p1->len(); i++) {
     Monomial* m = p1->get_mon(i);
-    mpz_tdiv_r_2exp(coeff, m->coeff, exp);
-    if (mpz_sgn(coeff) != 0) {
+    coeff.tdiv_r_2exp(m->get_coeff(), exp);
+    if (coeff.sgn() != 0) {
       Monomial* tmp;
       if (m->get_term())
         tmp = new Monomial(coeff, m->get_term_copy());
@@ -238,18 +233,16 @@ mod_poly(Polynomial* p1, int exp) {
       push_mstack_end(tmp);
     }
   }
-  mpz_clear(coeff);
   Polynomial* out = build_poly();
 
   if (proof_logging) {
-    mpz_t quot;
-    mpz_init(quot);
+    Coeff quot;
     for (size_t i = 0; i < p1->len(); i++) {
       Monomial* m = p1->get_mon(i);
 
-      mpz_tdiv_q_2exp(quot, m->coeff, exp);
-      if (mpz_sgn(quot) != 0) {
-        mpz_neg(quot, quot);
+      quot.tdiv_q_2exp(m->get_coeff(), exp);
+      if (quot.sgn() != 0) {
+        quot.neg(quot);
         Monomial* tmp;
         if (m->get_term())
           tmp = new Monomial(quot, m->get_term_copy());
@@ -258,7 +251,6 @@ mod_poly(Polynomial* p1, int exp) {
         push_mstack_end(tmp);
       }
     }
-    mpz_clear(quot);
 
     Polynomial* p = build_poly();
     if (p) {
@@ -358,7 +350,7 @@ remove_vanishing_monomials(Polynomial* p,
       if (!flag)
         push_mstack(m->copy());
       else if (shrunk)
-        push_mstack(new Monomial(m->coeff, shrunk->copy()));
+        push_mstack(new Monomial(m->get_coeff(), shrunk->copy()));
     }
     Polynomial* rem = build_poly();
     // rem->print(stdout);
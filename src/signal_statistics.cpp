@@ -27,6 +27,15 @@ bool no_spec = 1;     // spec is provided in extra file
 size_t sc_depth = 2;
 size_t sc_fanout = 4;
 
+// Memory budget of the circuit cache in MB, 0 turns the limit off
+size_t cache_memory = 1024;
+
+// Threads proving guesses by kissat, 0 uses all cores
+size_t sat_threads = 0;
+
+// Sub-circuits with at most this many inputs are proven by truth tables
+size_t exhaustive_inputs = 20;
+
 // Ablation studies
 bool do_preprocessing = 1;
 bool do_vanishing_constraints = 0;
@@ -39,6 +48,17 @@ bool force_fglm = 0;
 bool force_guessing = 0;
 bool proof_logging = 0;
 bool force_vanishing_off = 0;
+bool dense_reduction = 1;
+bool native_coefficients = 1;
+bool do_term_compaction = 1;
+bool speculative_linearization = 1;
+bool multi_modular = 1;
+bool sparse_kernel = 1;
+bool incremental_kernel = 1;
+bool canonical_labeling = 1;
+bool bit_parallel_simulation = 1;
+bool streaming_guess_kernel = 1;
+bool simulation_filter = 1;
 
 // Statistics
 int van_mon_depth_count = 0;
@@ -50,6 +70,15 @@ int lin_xor_constraint_count = 0;
 int total_circuit_lin_count = 0;
 int equiv_gate_count = 0;
 int circut_cached_count = 0;
+int canonical_cached_count = 0;
+size_t circuit_cache_hit_count = 0;
+size_t circuit_cache_miss_count = 0;
+size_t circuit_cache_eviction_count = 0;
+size_t circuit_cache_bytes = 0;
+size_t max_circuit_cache_bytes = 0;
+size_t persistent_cache_size = 0;
+int persistent_cache_hit_count = 0;
+int persistent_cache_store_count = 0;
 int count_fglm_call = 0;
 int count_unique_gb_call = 0;
 int count_msolve_call = 0;
@@ -61,6 +90,11 @@ int correct_guess_count = 0;
 int count_guess_call = 0;
 int count_kissat_call = 0;
 int evaluated_guess_count= 0;
+int simulation_refuted_count = 0;
+int sat_refuted_count = 0;
+int exhaustive_guess_call_count = 0;
+int exhaustive_correct_count = 0;
+size_t exhaustive_assignment_count = 0;
 int total_guesses_count = 0;
 int max_guesses_count = 0;
 int max_iterations_count = 0;
@@ -86,6 +120,28 @@ int van_mon_used_count = 0;
 int non_linear_count = 0;
 int linear_count = 0;
 
+// Terms
+size_t max_term_slab_count = 0;
+size_t released_term_slab_count = 0;
+int term_compaction_count = 0;
+double term_load_factor = 0;
+double term_slab_occupancy = 0;
+
+// Matrices
+int modular_rref_count = 0;
+int rational_rref_count = 0;
+int rref_prime_count = 0;
+int max_rref_primes = 0;
+int sparse_kernel_count = 0;
+size_t max_dense_core = 0;
+size_t kernel_column_count = 0;
+size_t reused_kernel_column_count = 0;
+size_t aig_clause_count = 0;
+size_t guess_clause_count = 0;
+int lifted_guess_kernel_count = 0;
+int rational_guess_kernel_count = 0;
+size_t guess_sample_count = 0;
+
 FILE *proof_file = NULL;
 FILE *polys_file = NULL;
 
@@ -270,14 +326,22 @@ void print_statistics()
   msg("sub-circuits enlarged:     %13i (max: %i times)", circuit_enlarged_count, max_depth_count); //buggy
   msg("");
   msg("cached circuits found:     %13i (%6.2f%% of total linearizations)", circut_cached_count, percent(circut_cached_count, total_circuit_lin_count));
+  msg("  by canonical labeling:   %13i (%6.2f%% of total linearizations without)", canonical_cached_count, percent(circut_cached_count-canonical_cached_count, total_circuit_lin_count));
+  msg("  from cache file:         %13i (%lu sub-circuits loaded, %i stored)", persistent_cache_hit_count, persistent_cache_size, persistent_cache_store_count);
+  msg("  memory cache hits:       %13lu (%lu misses, %lu evictions)", circuit_cache_hit_count, circuit_cache_miss_count, circuit_cache_eviction_count);
+  msg("  memory cache size:       %13.2f MB (max: %.2f MB)", circuit_cache_bytes / (double)(1 << 20), max_circuit_cache_bytes / (double)(1 << 20));
   msg("new computations:          %13i (%6.2f%% of total linearizations)", total_circuit_lin_count-circut_cached_count, percent(total_circuit_lin_count-circut_cached_count, total_circuit_lin_count));
   int unique = total_circuit_lin_count-circut_cached_count;
   msg("  guess and prove calls:   %13i (%6.2f%% of new computations)", count_guess_call, percent(count_guess_call, unique));
   msg("    kissat calls:          %13i", count_kissat_call);
+  msg("    exhaustive calls:      %13i (%lu assignments, %i proven poly)", exhaustive_guess_call_count, exhaustive_assignment_count, exhaustive_correct_count);
+  msg("    clauses:               %13lu (%lu of gates, %lu of guesses)", aig_clause_count + guess_clause_count, aig_clause_count, guess_clause_count);
   msg("    guessed poly:          %13i (max: %2i, avg: %3.1f)", total_guesses_count, max_guesses_count, average(total_guesses_count, total_iterations_count));
   msg("    evaluated guessed poly:%13i (%6.2f%% of total guesses)", evaluated_guess_count, percent(evaluated_guess_count, total_guesses_count));
   msg("    correct guessed poly:  %13i (%6.2f%% of evaluated guesses)", correct_guess_count, percent(correct_guess_count, evaluated_guess_count));
+  msg("    refuted guessed poly:  %13i (%i by simulation, %i by kissat)", simulation_refuted_count + sat_refuted_count, simulation_refuted_count, sat_refuted_count);
   msg("    iterations:            %13i (max: %2i, avg: %3.1f)", total_iterations_count, max_iterations_count, average(total_iterations_count, count_guess_call));
+  msg("    samples:               %13lu (avg: %.1f per call)", guess_sample_count, average(guess_sample_count, count_guess_call));
   msg_nl("    average accuracies:               ");
    
     for(int i = 0; i<max_iterations_count;i++){
@@ -302,6 +366,21 @@ void print_statistics()
   msg("non-linear reductions:     %13i (%6.2f %)", non_linear_count,
       percent(non_linear_count, linear_count + non_linear_count));
   msg("");
+  msg("TERMS: ");
+  msg("table load factor:         %13.2f", term_load_factor);
+  msg("slab occupancy:            %13.2f %%", 100.0 * term_slab_occupancy);
+  msg("slabs allocated:           %13lu (max: %lu)", max_term_slab_count + released_term_slab_count, max_term_slab_count);
+  msg("slabs released:            %13lu", released_term_slab_count);
+  msg("compactions:               %13i", term_compaction_count);
+  msg("");
+  msg("MATRICES: ");
+  msg("multi-modular rref:        %13i (%6.2f %%)", modular_rref_count, percent(modular_rref_count, modular_rref_count + rational_rref_count));
+  msg("rational rref:             %13i (%6.2f %%)", rational_rref_count, percent(rational_rref_count, modular_rref_count + rational_rref_count));
+  msg("primes:                    %13i (max: %i)", rref_prime_count, max_rref_primes);
+  msg("sparse kernels:            %13i (max dense core: %lu entries)", sparse_kernel_count, max_dense_core);
+  msg("incremental columns:       %13lu (%6.2f %% reused)", kernel_column_count, percent(reused_kernel_column_count, kernel_column_count));
+  msg("streamed guess kernels:    %13i (%6.2f %% lifted from one prime)", lifted_guess_kernel_count + rational_guess_kernel_count, percent(lifted_guess_kernel_count, lifted_guess_kernel_count + rational_guess_kernel_count));
+  msg("");
   msg("TIME AND MEMORY: ");
   msg("maximum resident set size:     %12.2f MB", maximum_resident_set_size() / static_cast<double>((1 << 20)));
   double end_time = process_time();
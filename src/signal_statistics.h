@@ -39,6 +39,17 @@ extern bool use_algebra_reduction;
 extern bool force_fglm;
 extern bool force_guessing;
 extern bool force_vanishing_off;
+extern bool dense_reduction;
+extern bool native_coefficients;
+extern bool do_term_compaction;
+extern bool speculative_linearization;
+extern bool multi_modular;
+extern bool sparse_kernel;
+extern bool incremental_kernel;
+extern bool canonical_labeling;
+extern bool bit_parallel_simulation;
+extern bool streaming_guess_kernel;
+extern bool simulation_filter;
 
 // Statistic counters
 extern int van_mon_depth_count;
@@ -54,7 +65,34 @@ extern int equiv_gate_count;
 extern int lin_xor_constraint_count;
 extern int non_linear_count;
 extern int linear_count;
+extern size_t max_term_slab_count;
+extern size_t released_term_slab_count;
+extern int term_compaction_count;
+extern double term_load_factor;    // load factor of the term table at exit
+extern double term_slab_occupancy; // fraction of used term slots at exit
+extern int modular_rref_count;
+extern int rational_rref_count;
+extern int rref_prime_count;
+extern int max_rref_primes;
+extern int sparse_kernel_count;
+extern size_t max_dense_core;
+extern size_t kernel_column_count;
+extern size_t reused_kernel_column_count;
+extern size_t aig_clause_count;
+extern size_t guess_clause_count;
+extern int lifted_guess_kernel_count;
+extern int rational_guess_kernel_count;
+extern size_t guess_sample_count;
 extern int circut_cached_count;
+extern int canonical_cached_count;
+extern size_t circuit_cache_hit_count;
+extern size_t circuit_cache_miss_count;
+extern size_t circuit_cache_eviction_count;
+extern size_t circuit_cache_bytes;
+extern size_t max_circuit_cache_bytes;
+extern size_t persistent_cache_size;
+extern int persistent_cache_hit_count;
+extern int persistent_cache_store_count;
 extern int van_mon_poly_count;
 extern int van_mon_prop_count;
 extern int van_mon_used_count;
@@ -63,6 +101,11 @@ extern int circuit_enlarged_count;
 extern int max_depth_count;
 extern int correct_guess_count;
 extern int evaluated_guess_count;
+extern int simulation_refuted_count;
+extern int sat_refuted_count;
+extern int exhaustive_guess_call_count;
+extern int exhaustive_correct_count;
+extern size_t exhaustive_assignment_count;
 extern int total_guesses_count;
 extern int max_guesses_count;
 extern int max_iterations_count;
@@ -80,6 +123,15 @@ extern FILE *polys_file;
 extern size_t sc_depth;
 extern size_t sc_fanout;
 
+// Memory budget of the circuit cache in MB
+extern size_t cache_memory;
+
+// Threads proving guesses by kissat, 0 uses all cores
+extern size_t sat_threads;
+
+// Sub-circuits with at most this many inputs are proven by truth tables
+extern size_t exhaustive_inputs;
+
 extern bool booth;
 
 
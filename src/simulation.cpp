@@ -0,0 +1,112 @@
+/*------------------------------------------------------------------------*/
+/*! \file simulation.cpp
+    \brief contains the bit-parallel simulation of sub-circuits
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#include "simulation.h"
+
+#include <algorithm>
+/*------------------------------------------------------------------------*/
+
+// / maximal number of arguments of an operation
+static const size_t max_args = 6;
+
+/*------------------------------------------------------------------------*/
+
+bool
+SubcircuitSimulator::compile(const std::vector<Gate*>& inputs,
+                             const std::vector<Gate*>& gates) {
+  num_inputs = inputs.size();
+  ops.clear();
+  slot_of.clear();
+  for(size_t i = 0; i < inputs.size(); i++)
+    slot_of[inputs[i]->get_var()] = i;
+
+  for(const auto& g : gates) {
+    // the leading monomial is the gate itself
+    const Polynomial* p = g->get_aig_poly();
+    Operation op;
+    for(size_t i = 1; i < p->len(); i++) {
+      for(Term* t = p->get_mon(i)->get_term(); t; t = t->get_rest()) {
+        Var* v = t->get_var();
+        if(v->is_dual())
+          v = v->get_dual();
+        auto it = slot_of.find(v);
+        if(it == slot_of.end())
+          return 0;
+        if(std::find(op.args.begin(), op.args.end(), it->second)
+           == op.args.end())
+          op.args.push_back(it->second);
+      }
+    }
+    if(op.args.size() > max_args)
+      return 0;
+
+    // evaluate the tail for every minterm of the arguments
+    op.table = 0;
+    for(uint64_t m = 0; m < (1ull << op.args.size()); m++) {
+      long val = 0;
+      for(size_t i = 1; i < p->len(); i++) {
+        Monomial* mon = p->get_mon(i);
+        if(!mon->get_coeff().fits_si())
+          return 0;
+        long term_val = 1;
+        for(Term* t = mon->get_term(); t && term_val; t = t->get_rest()) {
+          Var* v = t->get_var();
+          size_t s = slot_of[v->is_dual() ? v->get_dual() : v];
+          size_t a = std::find(op.args.begin(), op.args.end(), s)
+                     - op.args.begin();
+          bool bit = (m >> a) & 1;
+          term_val = v->is_dual() ? !bit : bit;
+        }
+        val += mon->get_coeff().get_si() * term_val;
+      }
+      if(val != 0 && val != 1)
+        return 0;
+      if(val)
+        op.table |= 1ull << m;
+    }
+
+    slot_of[g->get_var()] = num_inputs + ops.size();
+    ops.push_back(std::move(op));
+  }
+
+  words.assign(size() * block_words, 0);
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+
+long
+SubcircuitSimulator::find_slot(Var* v) const {
+  auto it = slot_of.find(v);
+  return it == slot_of.end() ? -1 : static_cast<long>(it->second);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+SubcircuitSimulator::simulate() {
+  for(size_t k = 0; k < ops.size(); k++) {
+    const Operation& op = ops[k];
+    uint64_t res[block_words] = { 0 };
+    for(uint64_t m = 0; m < (1ull << op.args.size()); m++) {
+      if(!((op.table >> m) & 1))
+        continue;
+      uint64_t minterm[block_words];
+      std::fill(minterm, minterm + block_words, ~0ull);
+      for(size_t a = 0; a < op.args.size(); a++) {
+        const uint64_t* x = slot(op.args[a]);
+        uint64_t flip = (m >> a) & 1 ? 0 : ~0ull;
+        for(size_t w = 0; w < block_words; w++)
+          minterm[w] &= x[w] ^ flip;
+      }
+      for(size_t w = 0; w < block_words; w++)
+        res[w] |= minterm[w];
+    }
+    std::copy(res, res + block_words, slot(num_inputs + k));
+  }
+}
@@ -0,0 +1,100 @@
+/*------------------------------------------------------------------------*/
+/*! \file simulation.h
+    \brief contains the bit-parallel simulation of sub-circuits
+
+  Guess-and-prove samples thousands of input assignments of a sub-circuit.
+  Instead of evaluating the AIG polynomial of every gate per assignment,
+  the sub-circuit is compiled once into a topologically ordered list of
+  operations on words, where every bit of a word belongs to a different
+  assignment. Each operation computes a gate from at most six arguments
+  by its truth table, which for an AND gate is a single minterm.
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#ifndef TALISMAN_SRC_SIMULATION_H_
+#define TALISMAN_SRC_SIMULATION_H_
+/*------------------------------------------------------------------------*/
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "gate.h"
+/*------------------------------------------------------------------------*/
+
+/** \class SubcircuitSimulator
+    Simulates a sub-circuit on block_bits input assignments at once. Slots
+    0, ..., num_inputs - 1 hold the inputs, the following slots the gates
+    in the order in which they were compiled.
+*/
+class SubcircuitSimulator {
+  public:
+  // / words per slot, the loops over a block are vectorized by the compiler
+  static const size_t block_words = 4;
+
+  // / assignments that are simulated at once
+  static const size_t block_bits = 64 * block_words;
+
+  private:
+  struct Operation {
+    // / slots of the arguments, the first is the least significant bit of a
+    // / minterm
+    std::vector<size_t> args;
+
+    // / truth table of the gate over its arguments
+    uint64_t table;
+  };
+
+  size_t num_inputs = 0;
+
+  // / operation of each gate slot
+  std::vector<Operation> ops;
+
+  // / slot of each variable
+  std::unordered_map<Var*, size_t> slot_of;
+
+  // / block_words words per slot
+  std::vector<uint64_t> words;
+
+  public:
+  /** Compiles the AIG polynomials of the gates. Every gate may only depend
+      on the inputs and on gates compiled before it.
+
+      @param inputs inputs of the sub-circuit
+      @param gates gates of the sub-circuit in topological order
+
+      @return false if a gate depends on other variables or cannot be
+              represented by a truth table
+  */
+  bool compile(const std::vector<Gate*>& inputs,
+               const std::vector<Gate*>& gates);
+
+  /** Getter for the number of slots
+
+      @return size_t
+  */
+  size_t size() const { return num_inputs + ops.size(); }
+
+  /** Getter for the words of a slot, the words of the inputs need to be set
+      before calling simulate()
+
+      @param slot index
+
+      @return pointer to block_words words
+  */
+  uint64_t* slot(size_t slot) { return &words[slot * block_words]; }
+
+  /** Getter for the slot of a variable
+
+      @param v Var*
+
+      @return slot, or -1 if v is no input or gate
+  */
+  long find_slot(Var* v) const;
+
+  /** Computes the words of all gates from the words of the inputs */
+  void simulate();
+};
+
+#endif// TALISMAN_SRC_SIMULATION_H_
@@ -0,0 +1,568 @@
+/*------------------------------------------------------------------------*/
+/*! \file sparse_matrix.cpp
+    \brief contains sparse integer matrices and their kernel
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#include "sparse_matrix.h"
+
+#include <assert.h>
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+
+#include "signal_statistics.h"
+/*------------------------------------------------------------------------*/
+
+// / density of the active sub-matrix at which it is eliminated densely
+static const double dense_core_density = 0.3;
+
+/*------------------------------------------------------------------------*/
+
+size_t
+SparseMatrix::nonzeros() const {
+  size_t res = 0;
+  for(const auto& row : rows)
+    res += row.size();
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+SparseMatrix::push_entry(size_t i, size_t j, const Coeff& c) {
+  assert(rows[i].empty() || rows[i].back().first < j);
+  assert(c.sgn() != 0);
+  rows[i].emplace_back(j, c);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+set_fmpq(fmpq_t q, const Coeff& c) {
+  if(c.fits_si()) {
+    fmpq_set_si(q, c.get_si(), 1);
+    return;
+  }
+  mpz_t tmp;
+  mpz_init(tmp);
+  c.get_mpz(tmp);
+  fmpz_set_mpz(fmpq_numref(q), tmp);
+  fmpz_one(fmpq_denref(q));
+  mpz_clear(tmp);
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+set_fmpz(fmpz_t z, const Coeff& c) {
+  if(c.fits_si()) {
+    fmpz_set_si(z, c.get_si());
+    return;
+  }
+  mpz_t tmp;
+  mpz_init(tmp);
+  c.get_mpz(tmp);
+  fmpz_set_mpz(z, tmp);
+  mpz_clear(tmp);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+SparseMatrix::to_dense(fmpq_mat_t mat) const {
+  fmpq_mat_init(mat, rows.size(), num_cols);
+  for(size_t i = 0; i < rows.size(); i++)
+    for(const auto& [j, c] : rows[i])
+      set_fmpq(fmpq_mat_entry(mat, i, j), c);
+}
+
+/*------------------------------------------------------------------------*/
+// Brings a basis of a kernel into rref with negative pivots, which is the
+// form of kernel() of matrix.h
+static void
+negated_rref(fmpz_mat_t K) {
+  rref_fraction_free(K);
+  for(long i = 0; i < fmpz_mat_nrows(K); i++)
+    for(long j = 0; j < fmpz_mat_ncols(K); j++)
+      fmpz_neg(fmpz_mat_entry(K, i, j), fmpz_mat_entry(K, i, j));
+}
+
+/*------------------------------------------------------------------------*/
+// Greatest common divisor of two inline coefficients, 1 otherwise
+static int64_t
+small_gcd(const Coeff& a, const Coeff& b) {
+  if(!a.fits_si() || !b.fits_si())
+    return 1;
+  int64_t x = a.get_si(), y = b.get_si();
+  uint64_t g = std::gcd(x < 0 ? 0 - (uint64_t)x : (uint64_t)x,
+                        y < 0 ? 0 - (uint64_t)y : (uint64_t)y);
+  return g && g <= INT64_MAX ? (int64_t)g : 1;
+}
+
+/*------------------------------------------------------------------------*/
+// Divides the row by the gcd of its inline coefficients
+static void
+remove_content(SparseRow& row) {
+  if(row.empty())
+    return;
+  Coeff g = row[0].second;
+  for(const auto& entry : row) {
+    g = small_gcd(g, entry.second);
+    if(g.cmp_si(1) == 0)
+      return;
+  }
+  for(auto& entry : row)
+    entry.second.tdiv_q(entry.second, g);
+}
+
+/*------------------------------------------------------------------------*/
+
+/** \class StructuredElimination
+    Forward elimination of the sparse part of a matrix. Rows that have been
+    used as pivot are kept for the back substitution, all other rows are
+    active. Row lengths and column counts of the active sub-matrix are
+    maintained to choose pivots with small fill-in.
+*/
+class StructuredElimination {
+  std::vector<SparseRow>& rows;
+
+  // / number of active rows with a nonzero entry in the column
+  std::vector<size_t> col_count;
+
+  // / rows that contained the column at some point
+  std::vector<std::vector<size_t>> col_rows;
+
+  // / min-heap of rows by length, entries may be outdated
+  std::priority_queue<std::pair<size_t, size_t>,
+                      std::vector<std::pair<size_t, size_t>>,
+                      std::greater<std::pair<size_t, size_t>>>
+    by_length;
+
+  void add_to_column(size_t j, size_t i);
+  void remove_from_column(size_t j);
+  void eliminate(size_t i, size_t r, const Coeff& p, const Coeff& a);
+
+  public:
+  // / false for pivot rows and zero rows
+  std::vector<bool> active;
+
+  // / pivot rows and columns, in the order of elimination
+  std::vector<std::pair<size_t, size_t>> pivots;
+
+  size_t active_rows = 0;
+  size_t active_cols = 0;
+  size_t active_nonzeros = 0;
+
+  StructuredElimination(std::vector<SparseRow>& m, size_t num_cols);
+
+  /** Eliminates a single pivot
+
+      @return false if the active sub-matrix is zero or dense
+  */
+  bool step();
+
+  /** Number of active rows with a nonzero entry in column j
+
+      @return size_t
+  */
+  size_t count(size_t j) const { return col_count[j]; }
+};
+
+/*------------------------------------------------------------------------*/
+
+StructuredElimination::StructuredElimination(std::vector<SparseRow>& m,
+                                             size_t num_cols)
+  : rows(m)
+  , col_count(num_cols, 0)
+  , col_rows(num_cols)
+  , active(m.size(), 0) {
+  for(size_t i = 0; i < rows.size(); i++) {
+    if(rows[i].empty())
+      continue;
+    active[i] = 1;
+    active_rows++;
+    active_nonzeros += rows[i].size();
+    by_length.emplace(rows[i].size(), i);
+    for(const auto& entry : rows[i])
+      add_to_column(entry.first, i);
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+StructuredElimination::add_to_column(size_t j, size_t i) {
+  if(!col_count[j]++)
+    active_cols++;
+  col_rows[j].push_back(i);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+StructuredElimination::remove_from_column(size_t j) {
+  if(!--col_count[j])
+    active_cols--;
+}
+
+/*------------------------------------------------------------------------*/
+// Sets row i to (p*row_i - a*row_r)/g, where a is the entry of row i in
+// the pivot column and p the pivot
+void
+StructuredElimination::eliminate(size_t i,
+                                 size_t r,
+                                 const Coeff& p,
+                                 const Coeff& a) {
+  Coeff g = small_gcd(p, a);
+  Coeff u, v, x, y;
+  u.tdiv_q(p, g);
+  v.tdiv_q(a, g);
+  v.neg(v);
+  bool unit = u.cmp_si(1) == 0;
+
+  const SparseRow& row_i = rows[i];
+  const SparseRow& row_r = rows[r];
+  SparseRow res;
+  res.reserve(row_i.size() + row_r.size());
+
+  size_t k = 0, l = 0;
+  while(k < row_i.size() || l < row_r.size()) {
+    size_t ci = k < row_i.size() ? row_i[k].first : SIZE_MAX;
+    size_t cr = l < row_r.size() ? row_r[l].first : SIZE_MAX;
+    if(ci < cr) {
+      if(unit)
+        res.push_back(row_i[k]);
+      else {
+        x.mul(u, row_i[k].second);
+        res.emplace_back(ci, x);
+      }
+      k++;
+    } else if(cr < ci) {
+      // fill-in
+      y.mul(v, row_r[l].second);
+      res.emplace_back(cr, y);
+      add_to_column(cr, i);
+      l++;
+    } else {
+      x.mul(u, row_i[k].second);
+      y.mul(v, row_r[l].second);
+      x.add(x, y);
+      if(x.sgn())
+        res.emplace_back(ci, x);
+      else
+        remove_from_column(ci);
+      k++;
+      l++;
+    }
+  }
+  if(!unit)
+    remove_content(res);
+
+  active_nonzeros += res.size();
+  active_nonzeros -= rows[i].size();
+  rows[i].swap(res);
+
+  if(rows[i].empty()) {
+    active[i] = 0;
+    active_rows--;
+  } else {
+    by_length.emplace(rows[i].size(), i);
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+bool
+StructuredElimination::step() {
+  if(!active_rows)
+    return 0;
+  if(active_nonzeros >= dense_core_density * active_rows * active_cols)
+    return 0;
+
+  // shortest active row, entries of the heap are outdated if the length
+  // of the row has changed meanwhile
+  size_t r;
+  do {
+    auto [len, i] = by_length.top();
+    by_length.pop();
+    r = active[i] && rows[i].size() == len ? i : SIZE_MAX;
+  } while(r == SIZE_MAX);
+
+  // column with fewest entries, which minimizes the Markowitz count
+  // (len(r)-1)*(count(c)-1) within row r, unit pivots avoid growth
+  size_t best = 0;
+  for(size_t k = 1; k < rows[r].size(); k++) {
+    size_t ck = col_count[rows[r][k].first];
+    size_t cb = col_count[rows[r][best].first];
+    bool uk = rows[r][k].second.cmp_si(1) == 0 || rows[r][k].second.cmp_si(-1) == 0;
+    bool ub = rows[r][best].second.cmp_si(1) == 0 || rows[r][best].second.cmp_si(-1) == 0;
+    if(ck < cb || (ck == cb && uk && !ub))
+      best = k;
+  }
+  size_t c = rows[r][best].first;
+  Coeff p = rows[r][best].second;
+
+  // the pivot row leaves the active sub-matrix
+  active[r] = 0;
+  active_rows--;
+  active_nonzeros -= rows[r].size();
+  for(const auto& entry : rows[r])
+    remove_from_column(entry.first);
+  pivots.emplace_back(r, c);
+
+  std::vector<size_t> candidates;
+  candidates.swap(col_rows[c]);
+  for(const auto& i : candidates) {
+    if(!active[i])
+      continue;
+    auto it = std::lower_bound(rows[i].begin(), rows[i].end(), c,
+                               [](const auto& e, size_t j) { return e.first < j; });
+    if(it == rows[i].end() || it->first != c)
+      continue;
+    Coeff a = it->second;
+    eliminate(i, r, p, a);
+  }
+  return 1;
+}
+
+/*------------------------------------------------------------------------*/
+// Sets x_c of row n of K to -s/p. If p does not divide s, the row is
+// scaled by |p|/gcd(s,p) first, which keeps its signs. Destroys s and uses
+// h as temporary.
+static void
+solve_pivot(fmpz_mat_t K, size_t n, size_t c, fmpz_t s, const fmpz_t p,
+            fmpz_t h) {
+  fmpz_gcd(h, s, p);
+  fmpz_divexact(s, s, h);
+  fmpz_divexact(h, p, h);
+  if(!fmpz_is_pm1(h)) {
+    fmpz_t m;
+    fmpz_init(m);
+    fmpz_abs(m, h);
+    for(long j = 0; j < fmpz_mat_ncols(K); j++)
+      if(!fmpz_is_zero(fmpz_mat_entry(K, n, j)))
+        fmpz_mul(fmpz_mat_entry(K, n, j), fmpz_mat_entry(K, n, j), m);
+    fmpz_clear(m);
+  }
+  if(fmpz_sgn(h) > 0)
+    fmpz_neg(fmpz_mat_entry(K, n, c), s);
+  else
+    fmpz_set(fmpz_mat_entry(K, n, c), s);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+SparseMatrix::kernel(fmpz_mat_t K) {
+  sparse_kernel_count++;
+  StructuredElimination elim(rows, num_cols);
+  while(elim.step())
+    ;
+
+  // dense core consisting of the remaining active rows and columns
+  std::vector<long> core_col(num_cols, -1);
+  std::vector<size_t> core_cols;
+  for(size_t j = 0; j < num_cols; j++) {
+    if(elim.count(j)) {
+      core_col[j] = core_cols.size();
+      core_cols.push_back(j);
+    }
+  }
+  std::vector<size_t> core_rows;
+  for(size_t i = 0; i < rows.size(); i++)
+    if(elim.active[i])
+      core_rows.push_back(i);
+
+  size_t core_size = core_rows.size() * core_cols.size();
+  if(core_size > max_dense_core)
+    max_dense_core = core_size;
+
+  fmpz_mat_t D;
+  fmpz_mat_init(D, core_rows.size(), core_cols.size());
+  for(size_t k = 0; k < core_rows.size(); k++)
+    for(const auto& [j, c] : rows[core_rows[k]])
+      set_fmpz(fmpz_mat_entry(D, k, core_col[j]), c);
+  std::vector<size_t> core_pivots = rref_fraction_free(D);
+
+  // every column that is no pivot yields a vector of the kernel
+  std::vector<bool> is_pivot(num_cols, 0);
+  for(const auto& [r, c] : elim.pivots)
+    is_pivot[c] = 1;
+  for(const auto& c : core_pivots)
+    is_pivot[core_cols[c]] = 1;
+
+  size_t rank = elim.pivots.size() + core_pivots.size();
+  fmpz_mat_init(K, num_cols - rank, num_cols);
+
+  fmpz_t s, t;
+  fmpz_init(s);
+  fmpz_init(t);
+  size_t n = 0;
+  for(size_t f = 0; f < num_cols; f++) {
+    if(is_pivot[f])
+      continue;
+    fmpz_one(fmpz_mat_entry(K, n, f));
+
+    // pivots of the dense core are given by its rref, each pivot is solved
+    // by p*x_c = -s, which requires scaling if p does not divide s
+    if(core_col[f] >= 0) {
+      for(size_t k = 0; k < core_pivots.size(); k++) {
+        fmpz_mul(s, fmpz_mat_entry(D, k, core_col[f]), fmpz_mat_entry(K, n, f));
+        solve_pivot(K, n, core_cols[core_pivots[k]], s,
+                    fmpz_mat_entry(D, k, core_pivots[k]), t);
+      }
+    }
+
+    // back substitution of the sparse pivots
+    for(auto it = elim.pivots.rbegin(); it != elim.pivots.rend(); ++it) {
+      const auto& [r, c] = *it;
+      fmpz_zero(s);
+      const Coeff* p = 0;
+      for(const auto& [j, a] : rows[r]) {
+        if(j == c) {
+          p = &a;
+          continue;
+        }
+        if(fmpz_is_zero(fmpz_mat_entry(K, n, j)))
+          continue;
+        set_fmpz(t, a);
+        fmpz_addmul(s, t, fmpz_mat_entry(K, n, j));
+      }
+      if(fmpz_is_zero(s))
+        continue;
+      fmpz_t q;
+      fmpz_init(q);
+      set_fmpz(q, *p);
+      solve_pivot(K, n, c, s, q, t);
+      fmpz_clear(q);
+    }
+    n++;
+  }
+  fmpz_clear(s);
+  fmpz_clear(t);
+  fmpz_mat_clear(D);
+
+  negated_rref(K);
+}
+
+/*------------------------------------------------------------------------*/
+// Returns u*x + v*y
+static SparseRow
+combine(const Coeff& u, const SparseRow& x, const Coeff& v, const SparseRow& y) {
+  SparseRow res;
+  res.reserve(x.size() + y.size());
+  Coeff a, b;
+  size_t k = 0, l = 0;
+  while(k < x.size() || l < y.size()) {
+    size_t cx = k < x.size() ? x[k].first : SIZE_MAX;
+    size_t cy = l < y.size() ? y[l].first : SIZE_MAX;
+    if(cx < cy) {
+      a.mul(u, x[k++].second);
+      res.emplace_back(cx, a);
+    } else if(cy < cx) {
+      b.mul(v, y[l++].second);
+      res.emplace_back(cy, b);
+    } else {
+      a.mul(u, x[k++].second);
+      b.mul(v, y[l++].second);
+      a.add(a, b);
+      if(a.sgn())
+        res.emplace_back(cx, a);
+    }
+  }
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+// Divides both rows by the gcd of all their inline coefficients
+static void
+remove_content(SparseRow& x, SparseRow& y) {
+  if(x.empty() && y.empty())
+    return;
+  Coeff g = x.empty() ? y[0].second : x[0].second;
+  for(const auto* row : { &x, &y }) {
+    for(const auto& entry : *row) {
+      g = small_gcd(g, entry.second);
+      if(g.cmp_si(1) == 0)
+        return;
+    }
+  }
+  for(auto* row : { &x, &y })
+    for(auto& entry : *row)
+      entry.second.tdiv_q(entry.second, g);
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+IncrementalKernel::push_column(const SparseRow& col) {
+  size_t k = columns.size();
+  columns.push_back(col);
+  SparseRow v = col;
+  SparseRow t = { { k, Coeff(1) } };
+
+  // eliminating the pivot only introduces entries in smaller rows
+  while(!v.empty()) {
+    auto it = pivot_of.find(v.back().first);
+    if(it == pivot_of.end())
+      break;
+    const SparseRow& r = reduced[it->second];
+    Coeff g = small_gcd(r.back().second, v.back().second);
+    Coeff u, w;
+    u.tdiv_q(r.back().second, g);
+    w.tdiv_q(v.back().second, g);
+    w.neg(w);
+    v = combine(u, v, w, r);
+    t = combine(u, t, w, combination[it->second]);
+    remove_content(v, t);
+  }
+
+  if(!v.empty())
+    pivot_of[v.back().first] = k;
+  reduced.push_back(std::move(v));
+  combination.push_back(std::move(t));
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+IncrementalKernel::truncate(size_t n) {
+  while(columns.size() > n) {
+    if(!reduced.back().empty())
+      pivot_of.erase(reduced.back().back().first);
+    columns.pop_back();
+    reduced.pop_back();
+    combination.pop_back();
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+void
+IncrementalKernel::kernel(const std::vector<long>& position,
+                          size_t num_cols,
+                          fmpz_mat_t K) const {
+  size_t nullity = 0;
+  for(const auto& v : reduced)
+    if(v.empty())
+      nullity++;
+
+  fmpz_mat_init(K, nullity, num_cols);
+  size_t n = 0;
+  for(size_t k = 0; k < reduced.size(); k++) {
+    if(!reduced[k].empty())
+      continue;
+    for(const auto& [j, c] : combination[k]) {
+      assert(position[j] >= 0);
+      set_fmpz(fmpz_mat_entry(K, n, position[j]), c);
+    }
+    n++;
+  }
+
+  negated_rref(K);
+}
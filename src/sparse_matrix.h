@@ -0,0 +1,159 @@
+/*------------------------------------------------------------------------*/
+/*! \file sparse_matrix.h
+    \brief contains sparse integer matrices and their kernel
+
+  The matrices of run_fglm contain one column per normal form, which only
+  has a few monomials, and an identity column per linear term. Rows are
+  hence stored as sorted lists of nonzero entries and the kernel is
+  computed by structured Gaussian elimination. Pivots are chosen to keep
+  the fill-in small, and only the remaining core is eliminated densely,
+  once it is dense enough. All steps are fraction-free, hence coefficients
+  of arbitrary size stay exact integers.
+
+  Part of TalisMan
+  Copyright(C) 2025 TalisMan-Developers
+*/
+/*------------------------------------------------------------------------*/
+#ifndef TALISMAN_SRC_SPARSE_MATRIX_H_
+#define TALISMAN_SRC_SPARSE_MATRIX_H_
+/*------------------------------------------------------------------------*/
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "coefficient.h"
+#include "matrix.h"
+/*------------------------------------------------------------------------*/
+
+// / nonzero entries of a row, sorted by column
+typedef std::vector<std::pair<size_t, Coeff>> SparseRow;
+
+/** \class SparseMatrix
+    Integer matrix, whose rows only store their nonzero entries.
+    Coefficients are inline 64-bit integers that are promoted on overflow.
+*/
+class SparseMatrix {
+  // / number of columns
+  size_t num_cols;
+
+  // / rows of the matrix
+  std::vector<SparseRow> rows;
+
+  public:
+  /** Constructor, creates a zero matrix
+
+      @param r number of rows
+      @param c number of columns
+  */
+  SparseMatrix(size_t r, size_t c)
+    : num_cols(c)
+    , rows(r) {}
+
+  /** Getter for the number of rows
+
+      @return size_t
+  */
+  size_t nrows() const { return rows.size(); }
+
+  /** Getter for the number of columns
+
+      @return size_t
+  */
+  size_t ncols() const { return num_cols; }
+
+  /** Returns the number of nonzero entries
+
+      @return size_t
+  */
+  size_t nonzeros() const;
+
+  /** Appends an entry to row i, the columns of a row need to be added in
+      increasing order
+
+      @param i row
+      @param j column
+      @param c nonzero const Coeff&
+  */
+  void push_entry(size_t i, size_t j, const Coeff& c);
+
+  /** Stores the matrix in the dense matrix mat, which is initialized
+
+      @param mat fmpq_mat_t
+  */
+  void to_dense(fmpq_mat_t mat) const;
+
+  /** Computes the kernel of the matrix fraction-free, i.e., K is
+      initialized and contains the negated fraction-free reduced row
+      echelon form of a basis of the kernel, see rref_fraction_free() of
+      matrix.h. The matrix is destroyed.
+
+      @param K fmpz_mat_t
+  */
+  void kernel(fmpz_mat_t K);
+};
+
+/*------------------------------------------------------------------------*/
+
+/** \class IncrementalKernel
+    Kernel of an integer matrix whose columns are added one at a time.
+    Every added column is reduced against the previous ones, and its
+    reduced form is kept together with the combination of added columns it
+    represents. Reduced columns are never changed afterwards, hence the
+    elimination of a prefix of the columns can be restored by truncation.
+    This allows reusing the elimination if a matrix is extended and only
+    few of its columns change.
+*/
+class IncrementalKernel {
+  // / added columns
+  std::vector<SparseRow> columns;
+
+  // / reduced columns, the pivot of a column is its entry of largest row
+  std::vector<SparseRow> reduced;
+
+  // / reduced columns as combination of added columns
+  std::vector<SparseRow> combination;
+
+  // / reduced column with pivot in a row
+  std::unordered_map<size_t, size_t> pivot_of;
+
+  public:
+  /** Returns the number of added columns
+
+      @return size_t
+  */
+  size_t size() const { return columns.size(); }
+
+  /** Getter for the k-th added column
+
+      @param k index
+
+      @return const SparseRow&
+  */
+  const SparseRow& column(size_t k) const { return columns[k]; }
+
+  /** Adds a column and reduces it against the previous columns
+
+      @param col SparseRow with entries sorted by row
+  */
+  void push_column(const SparseRow& col);
+
+  /** Removes all but the first n columns
+
+      @param n number of kept columns
+  */
+  void truncate(size_t n);
+
+  /** Computes the kernel in the same form as SparseMatrix::kernel. Column
+      k is moved to column position[k] of K, columns without position must
+      not occur in the kernel.
+
+      @param position long vector of size size(), negative if unused
+      @param num_cols number of columns of K
+      @param K fmpz_mat_t
+  */
+  void kernel(const std::vector<long>& position,
+              size_t num_cols,
+              fmpz_mat_t K) const;
+};
+
+#endif// TALISMAN_SRC_SPARSE_MATRIX_H_
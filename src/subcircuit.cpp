@@ -14,37 +14,32 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdio>
 #include <flint/fmpq_mat.h>
 #include <iostream>
 #include <memory>
 #include <random>
-#include <tuple>
+#include <thread>
 #include <unordered_set>
 
+#include "cnf.h"
+#include "guess_kernel.h"
 #include "matrix.h"
+#include "simulation.h"
 #include "term.h"
 /*------------------------------------------------------------------------*/
-std::set<Gate*, LargerGate> var;
-std::set<Gate*, LargerGate> sc_inputs;  // check whether sets are actually the
-                                        // most appropriate data structures
-std::set<Gate*, SmallerGate> gate_poly;
-
-size_t fanout_size_last_call = 0;
-
-
-
 /*------------------------------------------------------------------------*/
 static void
-print_subcircuit_guessing(Gate* root, int depth, size_t fanout_size) {
+print_subcircuit_guessing(LinearizationContext& ctx, Gate* root, int depth, size_t fanout_size) {
   msg("");
   msg("subcircuit with root %s at dist %i, depth %i, fanout size %i:",
       root->get_var_name(),
       root->get_dist(),
       depth,
       fanout_size);
-  msg("%i gates:", gate_poly.size());
-  for (auto& g : gate_poly) {
+  msg("%i gates:", ctx.gate_poly.size());
+  for (auto& g : ctx.gate_poly) {
     msg_nl("  %s, dist %i, parentsize %i   ",
            g->get_var_name(),
            g->get_dist(),
@@ -52,8 +47,8 @@ print_subcircuit_guessing(Gate* root, int depth, size_t fanout_size) {
     g->print_gate_constraint(stdout);
   }
   msg("");
-  msg("%i inputs:", sc_inputs.size());
-  for (auto& g : sc_inputs) {
+  msg("%i inputs:", ctx.sc_inputs.size());
+  for (auto& g : ctx.sc_inputs) {
     if (g->get_dist()) {
       msg_nl("  %s, dist %i, parentsize %i   ",
              g->get_var_name(),
@@ -72,46 +67,46 @@ print_subcircuit_guessing(Gate* root, int depth, size_t fanout_size) {
 }
 /*------------------------------------------------------------------------*/
 static void
-add_children_guessing(Gate* g, Gate* root, int depth, size_t fanout_size, bool init) {
+add_children_guessing(LinearizationContext& ctx, Gate* g, Gate* root, int depth, size_t fanout_size, bool init) {
   if (g->get_input())
     return;
   if (!depth)
     return;
   if (fanout_size && !init && g->aig_parents_size() >= fanout_size && !root->is_aig_child(g)) {
-    fanout_size_last_call = g->aig_parents_size();
+    ctx.fanout_size_last_call = g->aig_parents_size();
     return;
   }
 
-  if (!gate_poly.contains(g)) {
-    gate_poly.insert(g);
+  if (!ctx.gate_poly.contains(g)) {
+    ctx.gate_poly.insert(g);
   }
-  sc_inputs.erase(g);
-  var.insert(g);
+  ctx.sc_inputs.erase(g);
+  ctx.var.insert(g);
   if (verbose > 3)
     msg("added child %s, parentsize %i", g->get_var_name(), g->parents_size());
 
   for (auto& gc : g->get_aig_children()) {
     if (gc->get_elim())
       continue;
-    var.insert(gc);
-    if (!gate_poly.contains(gc)) {
+    ctx.var.insert(gc);
+    if (!ctx.gate_poly.contains(gc)) {
       if (verbose > 2)
         msg("inserted %s to sc_inputs", gc->get_var_name());
-      sc_inputs.insert(gc);
+      ctx.sc_inputs.insert(gc);
     }
   }
 
   for (auto& gc : g->get_children()) {
-    add_children_guessing(gc, root, depth - 1, fanout_size, 0);
+    add_children_guessing(ctx, gc, root, depth - 1, fanout_size, 0);
   }
 }
 /*------------------------------------------------------------------------*/
 static void
-push_inputs_guessing(size_t fanout_size) {
+push_inputs_guessing(LinearizationContext& ctx, size_t fanout_size) {
   std::vector<Gate*> placeholders;
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if (g->aig_parents_size() == 1 && g->aig_parents_size() < fanout_size && !g->get_xor_and_gate() && !g->get_input()) {
-      gate_poly.insert(g);
+      ctx.gate_poly.insert(g);
       placeholders.push_back(g);
       
       if (verbose > 1)
@@ -122,10 +117,10 @@ push_inputs_guessing(size_t fanout_size) {
       for (auto& gc : g->get_aig_children()) {
         if (gc->get_elim())
           continue;
-        var.insert(gc);
-        if (!gate_poly.contains(gc)) {
+        ctx.var.insert(gc);
+        if (!ctx.gate_poly.contains(gc)) {
           //     msg("inserted %s to sc_inputs", gc->get_var_name());
-          sc_inputs.insert(gc);
+          ctx.sc_inputs.insert(gc);
         }
       }
     }
@@ -133,13 +128,13 @@ push_inputs_guessing(size_t fanout_size) {
     if (g->get_dist() > 0) {
       bool flag = 1;
       for (auto& gc : g->get_aig_children()) {
-        if (!sc_inputs.contains(gc)) {
+        if (!ctx.sc_inputs.contains(gc)) {
           flag = 0;
           break;
         }
       }
       if (flag) {
-        gate_poly.insert(g);
+        ctx.gate_poly.insert(g);
         placeholders.push_back(g);
         if (verbose > 1)
           msg("pushed input %s whose inputs are inputs, parentsize %i",
@@ -150,36 +145,36 @@ push_inputs_guessing(size_t fanout_size) {
   }
 
   for (auto& g : placeholders) {
-    sc_inputs.erase(g);
+    ctx.sc_inputs.erase(g);
   }
 }
 /*------------------------------------------------------------------------*/
 
 static void
-push_pp_guessing() {
+push_pp_guessing(LinearizationContext& ctx) {
   std::vector<Gate*> placeholders;
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if (g->get_pp()) {
-      gate_poly.insert(g);
+      ctx.gate_poly.insert(g);
       placeholders.push_back(g);
       if (verbose > 1)
         msg(
             "pushed pp %s, parentsize %i", g->get_var_name(), g->aig_parents_size());
 
       for (auto& gc : g->get_aig_children()) {
-        var.insert(gc);
-        sc_inputs.insert(gc);
+        ctx.var.insert(gc);
+        ctx.sc_inputs.insert(gc);
       }
     }
   }
 
   for (auto& g : placeholders) {
-    sc_inputs.erase(g);
+    ctx.sc_inputs.erase(g);
   }
 }
 /*------------------------------------------------------------------------*/
 static void
-add_spouses_guessing(Gate* g) {
+add_spouses_guessing(LinearizationContext& ctx, Gate* g) {
   for (auto& gc : g->get_aig_children()) {
     if (gc->get_input())
       continue;
@@ -192,11 +187,11 @@ add_spouses_guessing(Gate* g) {
       if (g_sib->get_elim())
         continue;
 
-      if (!gate_poly.contains(g_sib) && !g_sib->get_input()) {
-        gate_poly.insert(g_sib);
+      if (!ctx.gate_poly.contains(g_sib) && !g_sib->get_input()) {
+        ctx.gate_poly.insert(g_sib);
       }
-      sc_inputs.erase(g_sib);
-      var.insert(g_sib);
+      ctx.sc_inputs.erase(g_sib);
+      ctx.var.insert(g_sib);
       if (verbose > 1)
         msg(
             "added spouse %s, dist %i", g_sib->get_var_name(), g_sib->get_dist());
@@ -204,9 +199,9 @@ add_spouses_guessing(Gate* g) {
       for (auto& gsib_c : g_sib->get_aig_children()) {
         if (gsib_c->get_elim())
           continue;
-        var.insert(gsib_c);
-        if (!gate_poly.contains(gsib_c))
-          sc_inputs.insert(gsib_c);
+        ctx.var.insert(gsib_c);
+        if (!ctx.gate_poly.contains(gsib_c))
+          ctx.sc_inputs.insert(gsib_c);
       }
     }
   }
@@ -214,7 +209,7 @@ add_spouses_guessing(Gate* g) {
 
 /*------------------------------------------------------------------------*/
 static void
-add_parents_guessing(Gate* node, Gate* g) {
+add_parents_guessing(LinearizationContext& ctx, Gate* node, Gate* g) {
   for (auto& node_p_val : node->get_aig_parents()) {
     Gate * node_p = gate(node_p_val);
     if (node_p->get_var_level() > g->get_var_level())
@@ -228,7 +223,7 @@ add_parents_guessing(Gate* node, Gate* g) {
     for (auto& node_p_c : node_p->get_aig_children()) {
       if (node == node_p_c)
         continue;
-      if (!var.contains(node_p_c)) {
+      if (!ctx.var.contains(node_p_c)) {
         flag = 1;
         break;
       }
@@ -236,22 +231,22 @@ add_parents_guessing(Gate* node, Gate* g) {
     if (flag)
       continue;
 
-    if (!gate_poly.contains(node_p) && !node_p->get_input()) {
-      gate_poly.insert(node_p);
+    if (!ctx.gate_poly.contains(node_p) && !node_p->get_input()) {
+      ctx.gate_poly.insert(node_p);
 
-      sc_inputs.erase(node_p);
+      ctx.sc_inputs.erase(node_p);
       if (verbose > 1)
         msg("added parent %s, dist %i", node_p->get_var_name(), g->get_dist());
-      var.insert(node_p);
-      add_parents_guessing(node_p, g);
+      ctx.var.insert(node_p);
+      add_parents_guessing(ctx, node_p, g);
     }
   }
 }
 
 /*------------------------------------------------------------------------*/
 static void
-add_common_ancestors_guessing(Gate* g) {
-  for (auto& node : var) {
+add_common_ancestors_guessing(LinearizationContext& ctx, Gate* g) {
+  for (auto& node : ctx.var) {
     for (auto& node_p_val : node->get_aig_parents()) {
       Gate * node_p = gate(node_p_val);
       if (node_p == g)
@@ -269,7 +264,7 @@ add_common_ancestors_guessing(Gate* g) {
       for (auto& node_p_c : node_p->get_aig_children()) {
         if (node == node_p_c)
           continue;
-        if (!var.contains(node_p_c)) {
+        if (!ctx.var.contains(node_p_c)) {
           flag = 1;
           break;
         }
@@ -278,23 +273,23 @@ add_common_ancestors_guessing(Gate* g) {
       if (flag)
         continue;
 
-      if (!gate_poly.contains(node_p) && !node_p->get_input()) {
+      if (!ctx.gate_poly.contains(node_p) && !node_p->get_input()) {
         if (verbose > 1)
           msg("added common ancestor %s, dist %i",
               node_p->get_var_name(),
               g->get_dist());
-        gate_poly.insert(node_p);
-        sc_inputs.erase(node_p);
-        var.insert(node_p);
-        add_parents_guessing(node_p, g);
+        ctx.gate_poly.insert(node_p);
+        ctx.sc_inputs.erase(node_p);
+        ctx.var.insert(node_p);
+        add_parents_guessing(ctx, node_p, g);
       }
     }
   }
 }
 /*------------------------------------------------------------------------*/
 static void
-add_ancestors_with_same_dist_guessing(Gate* g) {
-  for (auto& node : var) {
+add_ancestors_with_same_dist_guessing(LinearizationContext& ctx, Gate* g) {
+  for (auto& node : ctx.var) {
     for (auto& node_p_val : node->get_aig_parents()) {
       Gate * node_p = gate(node_p_val);
       if (node_p == g)
@@ -312,30 +307,30 @@ add_ancestors_with_same_dist_guessing(Gate* g) {
       for (auto& node_p_c : node_p->get_aig_children()) {
         if (node == node_p_c)
           continue;
-        if (!var.contains(node_p_c)) {
-          var.insert(node_p_c);
-          sc_inputs.insert(node_p_c);
+        if (!ctx.var.contains(node_p_c)) {
+          ctx.var.insert(node_p_c);
+          ctx.sc_inputs.insert(node_p_c);
         }
       }
 
-      if (!gate_poly.contains(node_p) && !node_p->get_input()) {
+      if (!ctx.gate_poly.contains(node_p) && !node_p->get_input()) {
         if (verbose > 1)
           msg("added same dist ancestor %s, dist %i",
               node_p->get_var_name(),
               g->get_dist());
-        gate_poly.insert(node_p);
-        sc_inputs.erase(node_p);
-        var.insert(node_p);
-        add_parents_guessing(node_p, g);
+        ctx.gate_poly.insert(node_p);
+        ctx.sc_inputs.erase(node_p);
+        ctx.var.insert(node_p);
+        add_parents_guessing(ctx, node_p, g);
       }
     }
   }
 }
 /*------------------------------------------------------------------------*/
 static bool
-expand_inputs_guessing(Gate* inp_g, int depth, size_t fanout_size) {
+expand_inputs_guessing(LinearizationContext& ctx, Gate* inp_g, int depth, size_t fanout_size) {
   bool flag_exit = 1;
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if (!g->get_input()) {
       flag_exit = 0;
     }
@@ -345,7 +340,7 @@ expand_inputs_guessing(Gate* inp_g, int depth, size_t fanout_size) {
   // check whether there is a suitable candidate for expansion
   Gate* exp = 0;
   std::vector<Gate*> placeholders;
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if(g->get_input()) continue;
     if (g->aig_parents_size() < fanout_size) {
       exp = g;
@@ -361,7 +356,7 @@ expand_inputs_guessing(Gate* inp_g, int depth, size_t fanout_size) {
   int i = 1;
   while (!exp && flag) {
     flag = 0;
-    for (auto& g : sc_inputs) {
+    for (auto& g : ctx.sc_inputs) {
       if (g->get_dist() > 1 && g->aig_parents_size() < fanout_size + i) {
         exp = g;
         break;
@@ -373,7 +368,7 @@ expand_inputs_guessing(Gate* inp_g, int depth, size_t fanout_size) {
   if (!exp) return 0;
   // count how many suitable candidates for expansions are there:
 
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if (g->get_dist() > 0 && g->aig_parents_size() <= fanout_size) {
       placeholders.push_back(g);
     }
@@ -381,16 +376,16 @@ expand_inputs_guessing(Gate* inp_g, int depth, size_t fanout_size) {
   // If only 3 suitable nodes can be expanded, we expand all of them
   if (placeholders.size() > 0 && placeholders.size() < 4) {
     for (auto& exp : placeholders) {
-      gate_poly.insert(exp);
+      ctx.gate_poly.insert(exp);
       if(verbose > 1) msg("expanded by %s", exp->get_var_name());
-      sc_inputs.erase(exp);
+      ctx.sc_inputs.erase(exp);
 
       for (auto& gc : exp->get_aig_children()) {
         if (gc->get_elim())
           continue;
-        var.insert(gc);
-        if (!gate_poly.contains(gc))
-          sc_inputs.insert(gc);
+        ctx.var.insert(gc);
+        if (!ctx.gate_poly.contains(gc))
+          ctx.sc_inputs.insert(gc);
       }
     }
 
@@ -398,13 +393,13 @@ expand_inputs_guessing(Gate* inp_g, int depth, size_t fanout_size) {
   }
 
   // expand single gate with max distance
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if (g->get_dist() > exp->get_dist() && g->aig_parents_size() < fanout_size)
       exp = g;
   }
 
-  gate_poly.insert(exp);
-  sc_inputs.erase(exp);
+  ctx.gate_poly.insert(exp);
+  ctx.sc_inputs.erase(exp);
 
   if (verbose > 1)
     msg("expand input %s, parentsize %i",
@@ -414,9 +409,9 @@ expand_inputs_guessing(Gate* inp_g, int depth, size_t fanout_size) {
   for (auto& gc : exp->get_aig_children()) {
     if (gc->get_elim())
       continue;
-    var.insert(gc);
-    if (!gate_poly.contains(gc))
-      sc_inputs.insert(gc);
+    ctx.var.insert(gc);
+    if (!ctx.gate_poly.contains(gc))
+      ctx.sc_inputs.insert(gc);
   }
   return 1;
 }
@@ -424,28 +419,28 @@ expand_inputs_guessing(Gate* inp_g, int depth, size_t fanout_size) {
 
 
 
-static bool subcircuit_for_guessing(Gate* g,
+static bool subcircuit_for_guessing(LinearizationContext& ctx, Gate* g,
   int depth,
   size_t fanout_size,
   int init,
   bool single_expand){
 bool expand = true;
     if (!single_expand)  // collect all children for certain depth
-      add_children_guessing(g, g, depth, fanout_size, 1);
+      add_children_guessing(ctx, g, g, depth, fanout_size, 1);
     else
-      expand = expand_inputs_guessing(g, depth, fanout_size);  // expand single inputs
+      expand = expand_inputs_guessing(ctx, g, depth, fanout_size);  // expand single inputs
     if (!expand)
       return false;
 
     // expand based on inputs and root node
-    add_ancestors_with_same_dist_guessing(g);
-    add_spouses_guessing(g);
-    push_inputs_guessing(fanout_size);
-    push_pp_guessing();
-    add_common_ancestors_guessing(g);
+    add_ancestors_with_same_dist_guessing(ctx, g);
+    add_spouses_guessing(ctx, g);
+    push_inputs_guessing(ctx, fanout_size);
+    push_pp_guessing(ctx);
+    add_common_ancestors_guessing(ctx, g);
 
     if (verbose > 1)
-      print_subcircuit_guessing(g, depth, fanout_size);
+      print_subcircuit_guessing(ctx, g, depth, fanout_size);
 
     return true;
   }
@@ -455,46 +450,46 @@ bool expand = true;
 // Identify Sub-Circuit no force guess
 /*------------------------------------------------------------------------*/
 static void
-add_children(Gate* g, Gate* root, int depth, size_t fanout_size, bool init) {
+add_children(LinearizationContext& ctx, Gate* g, Gate* root, int depth, size_t fanout_size, bool init) {
   if (g->get_input())
     return;
   if (!depth)
     return;
   if (fanout_size && !init && g->parents_size() >= fanout_size && !root->is_child(g)) {
-    fanout_size_last_call = g->parents_size();
+    ctx.fanout_size_last_call = g->parents_size();
     return;
   }
 
-  if (!gate_poly.contains(g)) {
-    gate_poly.insert(g);
+  if (!ctx.gate_poly.contains(g)) {
+    ctx.gate_poly.insert(g);
   }
-  sc_inputs.erase(g);
-  var.insert(g);
+  ctx.sc_inputs.erase(g);
+  ctx.var.insert(g);
   if (verbose > 3)
     msg("added child %s, parentsize %i", g->get_var_name(), g->parents_size());
 
   for (auto& gc : g->get_children()) {
     if (gc->get_elim())
       continue;
-    var.insert(gc);
-    if (!gate_poly.contains(gc)) {
+    ctx.var.insert(gc);
+    if (!ctx.gate_poly.contains(gc)) {
       if (verbose > 2)
         msg("inserted %s to sc_inputs", gc->get_var_name());
-      sc_inputs.insert(gc);
+      ctx.sc_inputs.insert(gc);
     }
   }
 
   for (auto& gc : g->get_children()) {
-    add_children(gc, root, depth - 1, fanout_size, 0);
+    add_children(ctx, gc, root, depth - 1, fanout_size, 0);
   }
 }
 /*------------------------------------------------------------------------*/
 static void
-push_inputs(size_t fanout_size) {
+push_inputs(LinearizationContext& ctx, size_t fanout_size) {
   std::vector<Gate*> placeholders;
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if (g->parents_size() == 1 && g->parents_size() < fanout_size && !g->get_xor_and_gate() && !g->get_input()) {
-      gate_poly.insert(g);
+      ctx.gate_poly.insert(g);
       placeholders.push_back(g);
       
       if (verbose > 1)
@@ -505,10 +500,10 @@ push_inputs(size_t fanout_size) {
       for (auto& gc : g->get_children()) {
         if (gc->get_elim())
           continue;
-        var.insert(gc);
-        if (!gate_poly.contains(gc)) {
+        ctx.var.insert(gc);
+        if (!ctx.gate_poly.contains(gc)) {
           //     msg("inserted %s to sc_inputs", gc->get_var_name());
-          sc_inputs.insert(gc);
+          ctx.sc_inputs.insert(gc);
         }
       }
     }
@@ -516,13 +511,13 @@ push_inputs(size_t fanout_size) {
     if (g->get_dist() > 0) {
       bool flag = 1;
       for (auto& gc : g->get_children()) {
-        if (!sc_inputs.contains(gc)) {
+        if (!ctx.sc_inputs.contains(gc)) {
           flag = 0;
           break;
         }
       }
       if (flag) {
-        gate_poly.insert(g);
+        ctx.gate_poly.insert(g);
         placeholders.push_back(g);
         if (verbose > 1)
           msg("pushed input %s whose inputs are inputs, parentsize %i",
@@ -533,36 +528,36 @@ push_inputs(size_t fanout_size) {
   }
 
   for (auto& g : placeholders) {
-    sc_inputs.erase(g);
+    ctx.sc_inputs.erase(g);
   }
 }
 /*------------------------------------------------------------------------*/
 
 static void
-push_pp() {
+push_pp(LinearizationContext& ctx) {
   std::vector<Gate*> placeholders;
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if (g->get_pp()) {
-      gate_poly.insert(g);
+      ctx.gate_poly.insert(g);
       placeholders.push_back(g);
       if (verbose > 1)
         msg(
             "pushed pp %s, parentsize %i", g->get_var_name(), g->parents_size());
 
       for (auto& gc : g->get_children()) {
-        var.insert(gc);
-        sc_inputs.insert(gc);
+        ctx.var.insert(gc);
+        ctx.sc_inputs.insert(gc);
       }
     }
   }
 
   for (auto& g : placeholders) {
-    sc_inputs.erase(g);
+    ctx.sc_inputs.erase(g);
   }
 }
 /*------------------------------------------------------------------------*/
 static void
-add_spouses(Gate* g) {
+add_spouses(LinearizationContext& ctx, Gate* g) {
   for (auto& gc : g->get_children()) {
     if (gc->get_input())
       continue;
@@ -574,11 +569,11 @@ add_spouses(Gate* g) {
       if (g_sib->get_elim())
         continue;
 
-      if (!gate_poly.contains(g_sib) && !g_sib->get_input()) {
-        gate_poly.insert(g_sib);
+      if (!ctx.gate_poly.contains(g_sib) && !g_sib->get_input()) {
+        ctx.gate_poly.insert(g_sib);
       }
-      sc_inputs.erase(g_sib);
-      var.insert(g_sib);
+      ctx.sc_inputs.erase(g_sib);
+      ctx.var.insert(g_sib);
       if (verbose > 1)
         msg(
             "added spouse %s, dist %i", g_sib->get_var_name(), g_sib->get_dist());
@@ -586,9 +581,9 @@ add_spouses(Gate* g) {
       for (auto& gsib_c : g_sib->get_children()) {
         if (gsib_c->get_elim())
           continue;
-        var.insert(gsib_c);
-        if (!gate_poly.contains(gsib_c))
-          sc_inputs.insert(gsib_c);
+        ctx.var.insert(gsib_c);
+        if (!ctx.gate_poly.contains(gsib_c))
+          ctx.sc_inputs.insert(gsib_c);
       }
     }
   }
@@ -596,7 +591,7 @@ add_spouses(Gate* g) {
 
 /*------------------------------------------------------------------------*/
 static void
-add_parents(Gate* node, Gate* g) {
+add_parents(LinearizationContext& ctx, Gate* node, Gate* g) {
   for (auto& node_p : node->get_parents()) {
     if (node_p->get_var_level() > g->get_var_level())
       continue;
@@ -609,7 +604,7 @@ add_parents(Gate* node, Gate* g) {
     for (auto& node_p_c : node_p->get_children()) {
       if (node == node_p_c)
         continue;
-      if (!var.contains(node_p_c)) {
+      if (!ctx.var.contains(node_p_c)) {
         flag = 1;
         break;
       }
@@ -617,22 +612,22 @@ add_parents(Gate* node, Gate* g) {
     if (flag)
       continue;
 
-    if (!gate_poly.contains(node_p) && !node_p->get_input()) {
-      gate_poly.insert(node_p);
+    if (!ctx.gate_poly.contains(node_p) && !node_p->get_input()) {
+      ctx.gate_poly.insert(node_p);
 
-      sc_inputs.erase(node_p);
+      ctx.sc_inputs.erase(node_p);
       if (verbose > 1)
         msg("added parent %s, dist %i", node_p->get_var_name(), g->get_dist());
-      var.insert(node_p);
-      add_parents(node_p, g);
+      ctx.var.insert(node_p);
+      add_parents(ctx, node_p, g);
     }
   }
 }
 
 /*------------------------------------------------------------------------*/
 static void
-add_common_ancestors(Gate* g) {
-  for (auto& node : var) {
+add_common_ancestors(LinearizationContext& ctx, Gate* g) {
+  for (auto& node : ctx.var) {
     for (auto& node_p : node->get_parents()) {
       if (node_p == g)
         continue;
@@ -649,7 +644,7 @@ add_common_ancestors(Gate* g) {
       for (auto& node_p_c : node_p->get_children()) {
         if (node == node_p_c)
           continue;
-        if (!var.contains(node_p_c)) {
+        if (!ctx.var.contains(node_p_c)) {
           flag = 1;
           break;
         }
@@ -658,23 +653,23 @@ add_common_ancestors(Gate* g) {
       if (flag)
         continue;
 
-      if (!gate_poly.contains(node_p) && !node_p->get_input()) {
+      if (!ctx.gate_poly.contains(node_p) && !node_p->get_input()) {
         if (verbose > 1)
           msg("added common ancestor %s, dist %i",
               node_p->get_var_name(),
               g->get_dist());
-        gate_poly.insert(node_p);
-        sc_inputs.erase(node_p);
-        var.insert(node_p);
-        add_parents(node_p, g);
+        ctx.gate_poly.insert(node_p);
+        ctx.sc_inputs.erase(node_p);
+        ctx.var.insert(node_p);
+        add_parents(ctx, node_p, g);
       }
     }
   }
 }
 /*------------------------------------------------------------------------*/
 static void
-add_ancestors_with_same_dist(Gate* g) {
-  for (auto& node : var) {
+add_ancestors_with_same_dist(LinearizationContext& ctx, Gate* g) {
+  for (auto& node : ctx.var) {
     for (auto& node_p : node->get_parents()) {
       if (node_p == g)
         continue;
@@ -691,30 +686,30 @@ add_ancestors_with_same_dist(Gate* g) {
       for (auto& node_p_c : node_p->get_children()) {
         if (node == node_p_c)
           continue;
-        if (!var.contains(node_p_c)) {
-          var.insert(node_p_c);
-          sc_inputs.insert(node_p_c);
+        if (!ctx.var.contains(node_p_c)) {
+          ctx.var.insert(node_p_c);
+          ctx.sc_inputs.insert(node_p_c);
         }
       }
 
-      if (!gate_poly.contains(node_p) && !node_p->get_input()) {
+      if (!ctx.gate_poly.contains(node_p) && !node_p->get_input()) {
         if (verbose > 1)
           msg("added same dist ancestor %s, dist %i",
               node_p->get_var_name(),
               g->get_dist());
-        gate_poly.insert(node_p);
-        sc_inputs.erase(node_p);
-        var.insert(node_p);
-        add_parents(node_p, g);
+        ctx.gate_poly.insert(node_p);
+        ctx.sc_inputs.erase(node_p);
+        ctx.var.insert(node_p);
+        add_parents(ctx, node_p, g);
       }
     }
   }
 }
 /*------------------------------------------------------------------------*/
 static bool
-expand_inputs(Gate* inp_g, int depth, size_t fanout_size) {
+expand_inputs(LinearizationContext& ctx, Gate* inp_g, int depth, size_t fanout_size) {
   bool flag_exit = 1;
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if (!g->get_input()) {
       flag_exit = 0;
     }
@@ -724,7 +719,7 @@ expand_inputs(Gate* inp_g, int depth, size_t fanout_size) {
   // check whether there is a suitable candidate for expansion
   Gate* exp = 0;
   std::vector<Gate*> placeholders;
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if(g->get_input()) continue;
     if (g->parents_size() < fanout_size) {
       exp = g;
@@ -740,7 +735,7 @@ expand_inputs(Gate* inp_g, int depth, size_t fanout_size) {
   int i = 1;
   while (!exp && flag) {
     flag = 0;
-    for (auto& g : sc_inputs) {
+    for (auto& g : ctx.sc_inputs) {
       if (g->get_dist() > 1 && g->parents_size() < fanout_size + i) {
         exp = g;
         break;
@@ -752,7 +747,7 @@ expand_inputs(Gate* inp_g, int depth, size_t fanout_size) {
   if (!exp) return 0;
   // count how many suitable candidates for expansions are there:
 
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if (g->get_dist() > 0 && g->parents_size() <= fanout_size) {
       placeholders.push_back(g);
     }
@@ -760,16 +755,16 @@ expand_inputs(Gate* inp_g, int depth, size_t fanout_size) {
   // If only 3 suitable nodes can be expanded, we expand all of them
   if (placeholders.size() > 0 && placeholders.size() < 4) {
     for (auto& exp : placeholders) {
-      gate_poly.insert(exp);
+      ctx.gate_poly.insert(exp);
       if(verbose > 1) msg("expanded by %s", exp->get_var_name());
-      sc_inputs.erase(exp);
+      ctx.sc_inputs.erase(exp);
 
       for (auto& gc : exp->get_children()) {
         if (gc->get_elim())
           continue;
-        var.insert(gc);
-        if (!gate_poly.contains(gc))
-          sc_inputs.insert(gc);
+        ctx.var.insert(gc);
+        if (!ctx.gate_poly.contains(gc))
+          ctx.sc_inputs.insert(gc);
       }
     }
 
@@ -777,13 +772,13 @@ expand_inputs(Gate* inp_g, int depth, size_t fanout_size) {
   }
 
   // expand single gate with max distance
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if (g->get_dist() > exp->get_dist() && g->parents_size() < fanout_size)
       exp = g;
   }
 
-  gate_poly.insert(exp);
-  sc_inputs.erase(exp);
+  ctx.gate_poly.insert(exp);
+  ctx.sc_inputs.erase(exp);
 
   if (verbose > 1)
     msg("expand input %s, parentsize %i",
@@ -793,24 +788,24 @@ expand_inputs(Gate* inp_g, int depth, size_t fanout_size) {
   for (auto& gc : exp->get_children()) {
     if (gc->get_elim())
       continue;
-    var.insert(gc);
-    if (!gate_poly.contains(gc))
-      sc_inputs.insert(gc);
+    ctx.var.insert(gc);
+    if (!ctx.gate_poly.contains(gc))
+      ctx.sc_inputs.insert(gc);
   }
   return 1;
 }
 /*------------------------------------------------------------------------*/
 
 static void
-print_subcircuit(Gate* root, int depth, size_t fanout_size) {
+print_subcircuit(LinearizationContext& ctx, Gate* root, int depth, size_t fanout_size) {
   msg("");
   msg("subcircuit with root %s at dist %i, depth %i, fanout size %i:",
       root->get_var_name(),
       root->get_dist(),
       depth,
       fanout_size);
-  msg("%i gates:", gate_poly.size());
-  for (auto& g : gate_poly) {
+  msg("%i gates:", ctx.gate_poly.size());
+  for (auto& g : ctx.gate_poly) {
     msg_nl("  %s, dist %i, parentsize %i   ",
            g->get_var_name(),
            g->get_dist(),
@@ -818,8 +813,8 @@ print_subcircuit(Gate* root, int depth, size_t fanout_size) {
     g->print_gate_constraint(stdout);
   }
   msg("");
-  msg("%i inputs:", sc_inputs.size());
-  for (auto& g : sc_inputs) {
+  msg("%i inputs:", ctx.sc_inputs.size());
+  for (auto& g : ctx.sc_inputs) {
     if (g->get_dist()) {
       msg_nl("  %s, dist %i, parentsize %i   ",
              g->get_var_name(),
@@ -838,7 +833,7 @@ print_subcircuit(Gate* root, int depth, size_t fanout_size) {
 }
 /*------------------------------------------------------------------------*/
 static void
-gen_fsa_subcircuit(Gate* g) {
+gen_fsa_subcircuit(LinearizationContext& ctx, Gate* g) {
   for (unsigned i = num_gates-1; i > 0; i--) {
     Gate* n = gates[i];
     if (n->get_elim() == 1)
@@ -849,8 +844,8 @@ gen_fsa_subcircuit(Gate* g) {
       continue;
 
     if (n->get_input()) {
-      sc_inputs.insert(n);
-      var.insert(n);
+      ctx.sc_inputs.insert(n);
+      ctx.var.insert(n);
     } else {
       bool flag = 0;
       for (auto& nc : n->get_children()) {
@@ -860,11 +855,11 @@ gen_fsa_subcircuit(Gate* g) {
         }
       }
       if (flag) {
-        sc_inputs.insert(n);
-        var.insert(n);
+        ctx.sc_inputs.insert(n);
+        ctx.var.insert(n);
       } else {
-        gate_poly.insert(n);
-        var.insert(n);
+        ctx.gate_poly.insert(n);
+        ctx.var.insert(n);
       }
     }
   }
@@ -882,46 +877,46 @@ bool is_internal_fsa(Gate* g) {
 }
 /*------------------------------------------------------------------------*/
 static bool
-get_subcircuit(Gate* g,
+get_subcircuit(LinearizationContext& ctx, Gate* g,
                int depth,
                size_t fanout_size,
                int init,
                bool single_expand) {
   if (init == 1) {
-    var.clear();
-    gate_poly.clear();
-    sc_inputs.clear();
+    ctx.var.clear();
+    ctx.gate_poly.clear();
+    ctx.sc_inputs.clear();
   }
 
   // if g belongs to specially marked circuit collect all nodes with same marking
   if (is_internal_fsa(g)) {
-    gen_fsa_subcircuit(g);
+    gen_fsa_subcircuit(ctx, g);
     if (verbose > 1)
-      print_subcircuit(g, depth, fanout_size);
+      print_subcircuit(ctx, g, depth, fanout_size);
  
     return true;
   } else if (force_guessing){
-    return subcircuit_for_guessing(g,depth,fanout_size,init,single_expand);
+    return subcircuit_for_guessing(ctx, g,depth,fanout_size,init,single_expand);
 
   } else {
     bool expand = true;
     if (!single_expand)  // collect all children for certain depth
-      add_children(g, g, depth, fanout_size, 1);
+      add_children(ctx, g, g, depth, fanout_size, 1);
     else
-      expand = expand_inputs(g, depth, fanout_size);  // expand single inputs
+      expand = expand_inputs(ctx, g, depth, fanout_size);  // expand single inputs
     if (!expand)
       return false;
 
     // expand based on inputs and root node
-    add_ancestors_with_same_dist(g);
-    add_spouses(g);
-    push_inputs(fanout_size);
-    push_pp();
-    add_common_ancestors(g);
+    add_ancestors_with_same_dist(ctx, g);
+    add_spouses(ctx, g);
+    push_inputs(ctx, fanout_size);
+    push_pp(ctx);
+    add_common_ancestors(ctx, g);
 
  
     if (verbose > 1)
-      print_subcircuit(g, depth, fanout_size);
+      print_subcircuit(ctx, g, depth, fanout_size);
 
     return true;
   }
@@ -933,7 +928,8 @@ normalize(const Polynomial* p, std::map<Var*, size_t>& var_to_id) {
 
   for (size_t i = 0; i < p->len(); i++) {
     Monomial* m = p->get_mon(i);
-    mpz_class c(m->coeff);
+    mpz_class c;
+    m->get_coeff().get_mpz(c.get_mpz_t());
     Term* t = m->get_term();
     std::vector<size_t> nt;
     if (!t)
@@ -952,7 +948,8 @@ normalize(const Polynomial* p, std::map<Var*, size_t>& var_to_id) {
 static void
 compress_subcircuit(std::set<Gate*, SmallerGate>& subcircuit,
                     std::vector<Normalized_poly>& res,
-                    std::map<Var*, size_t>& var_to_id) {
+                    std::map<Var*, size_t>& var_to_id,
+                    std::vector<Gate*>* new_nf) {
   res.clear();
   var_to_id.clear();
   // save id = 0 for constant coefficient
@@ -966,6 +963,8 @@ compress_subcircuit(std::set<Gate*, SmallerGate>& subcircuit,
       g = gate->get_gate_constraint();
       g = unflip_poly_and_remove_van_mon(g);
       gate->set_nf(g);
+      if (new_nf)
+        new_nf->push_back(gate);
     }
 
     for (size_t i = 0; i < g->len(); i++) {
@@ -985,15 +984,136 @@ compress_subcircuit(std::set<Gate*, SmallerGate>& subcircuit,
   }
 }
 /*------------------------------------------------------------------------*/
-bool get_and_compress_subcircuit(Gate* g,
+/**
+    Relabels the variables of the compressed subcircuit canonically, such
+    that isomorphic subcircuits, e.g., with commuted inputs, get the same
+    compressed form. The variables are colored by refining their colors by
+    the monomials and polynomials they occur in, until the number of colors
+    is stable. Multisets of colors are hashed by the sum of the hashes of
+    their elements, which does not depend on their order. Variables are then
+    numbered by color, and variables of equal color by decreasing level.
+    Finally, the terms, monomials and polynomials are sorted.
+
+    The cached linear polynomials only contain the relations whose leading
+    coefficient is +- 1 in the term order of the subcircuit, which is given
+    by the levels. The ids in decreasing level order are hence appended as
+    a last polynomial with coefficient 0, such that equal compressed forms
+    also have the same term order.
+*/
+static void
+canonicalize_subcircuit(std::vector<Normalized_poly>& res,
+                        std::map<Var*, size_t>& var_to_id) {
+  // the constant term has id 0 and keeps it
+  size_t n = var_to_id.size() + 1;
+  std::vector<int> level(n, 0);
+  for (const auto& [v, id] : var_to_id)
+    level[id] = v->get_level();
+  std::vector<uint64_t> var_color(n, 1), next_color(n), sorted;
+  var_color[0] = 0;
+
+  std::vector<std::vector<uint64_t>> mon_color(res.size());
+  std::vector<uint64_t> poly_color(res.size());
+  for (size_t k = 0; k < res.size(); k++)
+    mon_color[k].resize(res[k].size());
+
+  size_t num_colors = std::min<size_t>(n, 2);
+  for (size_t round = 0; round < n; round++) {
+    // color monomials by their coefficient and the colors of their variables
+    for (size_t k = 0; k < res.size(); k++) {
+      const Normalized_poly& p = res[k];
+      uint64_t sum = 0;
+      for (size_t i = 0; i < p.size(); i++) {
+        uint64_t c = 0;
+        for (auto v : p.terms[i])
+          c += hash_combine(0, var_color[v]);
+        c = hash_mpz(c, p.coeffs[i].get_mpz_t());
+        mon_color[k][i] = c;
+        sum += hash_combine(0, c);
+      }
+      poly_color[k] = hash_combine(p.size(), sum);
+    }
+
+    // refine variables by the colors of their occurrences
+    for (size_t v = 1; v < n; v++)
+      next_color[v] = 0;
+    for (size_t k = 0; k < res.size(); k++) {
+      const Normalized_poly& p = res[k];
+      for (size_t i = 0; i < p.size(); i++) {
+        uint64_t c = hash_combine(mon_color[k][i], poly_color[k]);
+        for (auto v : p.terms[i])
+          next_color[v] += c;
+      }
+    }
+    for (size_t v = 1; v < n; v++)
+      next_color[v] = hash_combine(var_color[v], next_color[v]);
+    next_color[0] = 0;
+
+    sorted = next_color;
+    std::sort(sorted.begin(), sorted.end());
+    size_t refined = std::unique(sorted.begin(), sorted.end()) - sorted.begin();
+    if (refined == num_colors)
+      break;
+    num_colors = refined;
+    std::swap(var_color, next_color);
+  }
+
+  std::vector<size_t> order(n);
+  for (size_t v = 0; v < n; v++)
+    order[v] = v;
+  std::sort(order.begin() + 1, order.end(), [&](size_t a, size_t b) {
+    if (var_color[a] != var_color[b])
+      return var_color[a] < var_color[b];
+    return level[a] > level[b];
+  });
+  std::vector<size_t> new_id(n);
+  for (size_t i = 0; i < n; i++)
+    new_id[order[i]] = i;
+  for (auto& [v, id] : var_to_id)
+    id = new_id[id];
+
+  for (auto& p : res) {
+    std::vector<std::pair<std::vector<size_t>, mpz_class>> mons;
+    mons.reserve(p.size());
+    for (size_t i = 0; i < p.size(); i++) {
+      std::vector<size_t>& t = p.terms[i];
+      for (auto& v : t)
+        v = new_id[v];
+      std::sort(t.begin(), t.end());
+      mons.emplace_back(std::move(t), std::move(p.coeffs[i]));
+    }
+    std::sort(mons.begin(), mons.end());
+    for (size_t i = 0; i < mons.size(); i++) {
+      p.terms[i] = std::move(mons[i].first);
+      p.coeffs[i] = std::move(mons[i].second);
+    }
+  }
+  std::sort(res.begin(), res.end(), [](const Normalized_poly& a,
+                                       const Normalized_poly& b) {
+    return std::tie(a.terms, a.coeffs) < std::tie(b.terms, b.coeffs);
+  });
+
+  // levels are unique, hence they order the variables totally
+  std::vector<size_t> by_level(order.begin() + 1, order.end());
+  std::sort(by_level.begin(), by_level.end(), [&](size_t a, size_t b) {
+    return level[a] > level[b];
+  });
+  for (auto& v : by_level)
+    v = new_id[v];
+  Normalized_poly level_order;
+  mpz_class zero = 0;
+  level_order.emplace_back(zero, by_level);
+  res.push_back(std::move(level_order));
+}
+/*------------------------------------------------------------------------*/
+bool get_and_compress_subcircuit(LinearizationContext& ctx,
+                                 Gate* g,
                                  int depth,
                                  size_t fanout_size,
                                  int init,
                                  bool single_expand,
-                                 std::vector<Normalized_poly>& normalized,
-                                 std::map<Var*, size_t>& var_to_id) {
+                                 std::vector<Gate*>* new_nf) {
   double pre_circuit_time = process_time();
-  if (!get_subcircuit(g, depth, fanout_size, init, single_expand)){
+  if (!get_subcircuit(ctx, g, depth, fanout_size, init, single_expand)){
     find_circuit_time += (process_time() - pre_circuit_time);
     return false;
   }
@@ -1001,7 +1121,12 @@ bool get_and_compress_subcircuit(Gate* g,
 
   // we do not compress internal-fsa as it will not be cached
   if (!is_internal_fsa(g) || force_fglm) {
-    compress_subcircuit(gate_poly, normalized, var_to_id);
+    compress_subcircuit(ctx.gate_poly, ctx.circuit, ctx.var_to_id, new_nf);
+    // proof patterns list their inputs in the order of gate_poly
+    if (canonical_labeling && !proof_logging) {
+      ctx.unlabeled_hash = circuit_hash()(ctx.circuit);
+      canonicalize_subcircuit(ctx.circuit, ctx.var_to_id);
+    }
   }
 
   find_circuit_time += (process_time() - pre_circuit_time);
@@ -1009,10 +1134,45 @@ bool get_and_compress_subcircuit(Gate* g,
 }
 /*------------------------------------------------------------------------*/
 // Computing normalforms
+/*------------------------------------------------------------------------*/
+// Reduces gpol by p and removes the vanishing monomials of the result
+static Polynomial*
+reduce_normal_form(Polynomial* gpol,
+                   Polynomial* p,
+                   std::vector<Polynomial*>* used_van_poly) {
+  if (verbose > 2) {
+    msg_nl("reducing by:");
+    p->print(stdout);
+  }
+  Polynomial* tmp = reduce_by_one_poly(gpol, p);
+  if (tmp->degree() > 1) {
+    Polynomial* tmp2 = remove_vanishing_monomials(tmp, used_van_poly);
+    delete (tmp);
+    tmp = tmp2;
+  }
+
+  if(!proof_logging) check_if_propagate(tmp);
+
+  if (verbose > 2) {
+    msg_nl("result:");
+    tmp->print(stdout);
+  }
+  delete (gpol);
+  return tmp;
+}
+
+/*------------------------------------------------------------------------*/
+// Linear polynomials of at most three monomials are checked for
+// propagation after every reduction step
+static bool
+may_propagate(const Polynomial* p) {
+  return p->degree() <= 1 && p->len() <= 3;
+}
+
 /*------------------------------------------------------------------------*/
 std::vector<Polynomial*>
-compute_normalforms(std::vector<Polynomial*>* used_van_poly, std::vector<Polynomial*>* new_nf_poly) {
-  if (gate_poly.size() == 0)
+compute_normalforms(LinearizationContext& ctx, std::vector<Polynomial*>* used_van_poly, std::vector<Polynomial*>* new_nf_poly) {
+  if (ctx.gate_poly.size() == 0)
     return {};
 
   if (verbose > 2)
@@ -1020,7 +1180,7 @@ compute_normalforms(std::vector<Polynomial*>* used_van_poly, std::vector<Polynom
 
   if (verbose > 2) {
     msg("input:");
-    for (const auto& gatep : gate_poly) {
+    for (const auto& gatep : ctx.gate_poly) {
       if (gatep->get_nf()) {
         msg_nl("recycled nf ");
         gatep->print_nf(stdout);
@@ -1034,7 +1194,7 @@ compute_normalforms(std::vector<Polynomial*>* used_van_poly, std::vector<Polynom
   }
 
   std::vector<Polynomial*> input_poly;
-  for (auto rit = gate_poly.rbegin(); rit != gate_poly.rend(); rit++) {
+  for (auto rit = ctx.gate_poly.rbegin(); rit != ctx.gate_poly.rend(); rit++) {
     Gate* gatep = *rit;
     Polynomial* gpol_raw = 0;
     if (gatep->get_nf()) {
@@ -1047,37 +1207,44 @@ compute_normalforms(std::vector<Polynomial*>* used_van_poly, std::vector<Polynom
     }
   }
 
-  std::vector<Polynomial*> rewritten;
-  for (auto it = input_poly.begin(); it != input_poly.end(); it++) {
-    Polynomial* gpol = *it;
+  // position of the polynomial of each leading variable
+  std::unordered_map<int, size_t> reducer_of;
+  for (size_t k = 0; k < input_poly.size(); k++)
+    reducer_of[input_poly[k]->get_lt()->get_var_num()] = k;
 
-    for (auto rit_inner = it; rit_inner != input_poly.end(); ++rit_inner) {
-      Polynomial* gatep_inner = *rit_inner;
+  std::vector<Polynomial*> rewritten;
+  for (size_t i = 0; i < input_poly.size(); i++) {
+    Polynomial* gpol = input_poly[i];
+
+    // gpol is reduced by the later polynomials in order, but those whose
+    // leading variable does not occur in gpol are skipped, as long as the
+    // vanishing monomials have been removed completely and gpol cannot be
+    // propagated. A pass of remove_vanishing_monomials() shrinks every
+    // monomial at most once, hence gpol is only known to be free of them
+    // after a pass that did not remove anything.
+    bool removed_vanishing = false;
+    size_t k = i;
+    while (k < input_poly.size() && gpol->len() > 1) {
+      if (removed_vanishing && !may_propagate(gpol)) {
+        size_t next = input_poly.size();
+        for (size_t j = 0; j < gpol->len(); j++) {
+          for (Term* t = gpol->get_mon(j)->get_term(); t; t = t->get_rest()) {
+            auto it = reducer_of.find(t->get_var_num());
+            if (it != reducer_of.end() && it->second >= k && it->second < next)
+              next = it->second;
+          }
+        }
+        k = next;
+        if (k == input_poly.size())
+          break;
+      }
 
+      Polynomial* gatep_inner = input_poly[k++];
       if (gpol->get_lt() == gatep_inner->get_lt())
         continue;
-      if (gpol->len() == 1)
-        continue;
-
-      if (verbose > 2) {
-        msg_nl("reducing by:");
-        gatep_inner->print(stdout);
-      }
-      Polynomial* tmp = reduce_by_one_poly(gpol, gatep_inner);
-      if (tmp->degree() > 1) {
-        Polynomial* tmp2 = remove_vanishing_monomials(tmp, used_van_poly);
-        delete (tmp);
-        tmp = tmp2;
-      }
-
-      if(!proof_logging) check_if_propagate(tmp);
-
-      if (verbose > 2) {
-        msg_nl("result:");
-        tmp->print(stdout);
-      }
-      delete (gpol);
-      gpol = tmp;
+      int pre_van_mon_used = van_mon_used_count;
+      gpol = reduce_normal_form(gpol, gatep_inner, used_van_poly);
+      removed_vanishing = van_mon_used_count == pre_van_mon_used;
     }
 
     if(!proof_logging) check_if_propagate(gpol);
@@ -1099,126 +1266,94 @@ compute_normalforms(std::vector<Polynomial*>* used_van_poly, std::vector<Polynom
   return rewritten;
 }
 
-/*------------------------------------------------------------------------*/
-/*------------------------------------------------------------------------*/
-std::deque<std::map<Gate*, bool>> collected_assignments;
 /*------------------------------------------------------------------------*/
 /*-----------------------------------------------------------------------*/
-static bool call_kissat(std::vector<std::vector<int>> cnf_clauses, std::map<int, Gate*> ids) {
-  count_kissat_call++;
+/**
+    Solves the shared clauses of the sub-circuit together with the clauses
+    of a guess by a fresh kissat instance. Only uses local state, hence it
+    can be called by several threads at once.
+
+    @param cnf encoding of the sub-circuit
+    @param guess clauses of the guess
+    @param model values of the variables of the gates if satisfiable
 
-  int max_lit = ids.size();
+    @return result of kissat, 10 if satisfiable and 20 if unsatisfiable
+*/
+static int solve_cnf(const SubcircuitCnf& cnf, const ClauseArena& guess, std::vector<bool>& model) {
   kissat* solver = kissat_init();
 
-  // Add CNF clauses to the solver
-  for (const auto& clause : cnf_clauses) {
-    for (int lit : clause) {
-      kissat_add(solver, lit);  // Add literal
-    }
-    kissat_add(solver, 0);  // Terminate clause
-  }
+  // Add CNF clauses to the solver, they are already terminated by zeros
+  for (int lit : cnf.clauses().literals())
+    kissat_add(solver, lit);
+  for (int lit : guess.literals())
+    kissat_add(solver, lit);
 
   // Solve the CNF
   kissat_set_option(solver, "quiet", 1);
   int result = kissat_solve(solver);
 
+  // Retrieve the satisfying assignment
+  if (result == 10) {
+    model.assign(cnf.max_lit() + 1, 0);
+    for (int var = 1; var <= cnf.max_lit(); var++)
+      model[var] = kissat_value(solver, var) > 0;
+  }
+
+  // Clean up
+  kissat_release(solver);
+  return result;
+}
+/*------------------------------------------------------------------------*/
+// Prints the result of kissat and collects the counter example
+static void collect_kissat_result(LinearizationContext& ctx, int result, const std::vector<bool>& model, const SubcircuitCnf& cnf) {
+  count_kissat_call++;
+
   // Print result
   if (result == 10) {  // SAT
     if (verbose > 2) std::cout << "SATISFIABLE\n";
     std::map<Gate*, bool> assignment;
-
-    // Retrieve and print the satisfying assignment
-    for (int var = 1; var <= max_lit; var++) {
-      int value = kissat_value(solver, var);
-      if (var <= max_lit) assignment.insert({ids[var], value > 0 ? 1 : 0});
-    }
-    collected_assignments.push_back(assignment);
+    for (size_t var = 1; var < model.size(); var++)
+      assignment.insert({cnf.gate_of(var), model[var]});
+    ctx.collected_assignments.push_back(assignment);
 
   } else if (result == 20) {  // UNSAT
     if (verbose > 2) std::cout << "UNSATISFIABLE\n";
   } else {
     if (verbose > 2) std::cout << "UNKNOWN result\n";
   }
-
-  // Clean up
-  kissat_release(solver);
+}
+/*------------------------------------------------------------------------*/
+static bool call_kissat(LinearizationContext& ctx, const SubcircuitCnf& cnf, const ClauseArena& guess) {
+  std::vector<bool> model;
+  int result = solve_cnf(cnf, guess, model);
+  collect_kissat_result(ctx, result, model, cnf);
   return result == 20;
 }
 /*------------------------------------------------------------------------*/
-static std::tuple<std::map<Gate*, int>, std::map<int, Gate*>>var_cnf_mapping(std::vector<Var*> vars){
-    // map literals to names
-    std::map<Gate*, int> lit_id;
-    std::map<int, Gate*> inverse_lit_id;
-    lit_id.clear();
-    int id = 1;
-  
-    // Generate the mappings
-    unsigned count = 0;
-    id = 1;
-    for(auto & v: vars){
-      Gate * g = gate(v->get_num());
-  
-      // check that vars are unique
-      if(lit_id.find(g) != lit_id.end()) die(4, "Gate %s already has id %i", lit_id[g]);
-  
-      inverse_lit_id[id] = g;
-      lit_id[g] = id++;
-    }
-
-  return {lit_id, inverse_lit_id}; 
+// Number of threads that prove guesses by kissat
+static size_t sat_workers() {
+  if (sat_threads)
+    return sat_threads;
+  return std::max(1u, std::thread::hardware_concurrency());
 }
-
-
 /*------------------------------------------------------------------------*/
-static std::vector<std::vector<int>> translate_aig_part_to_cnf(std::map<Gate*, int> lit_id){
-  PB2CNF pb2cnf;
-  std::vector<std::vector<int>> cnf_clauses;
-  int firstFreshVariable = lit_id.size() + 1;
-  int rhs = 1;
-  std::vector<int64_t> weights2 = {1, 1};
-  std::vector<int64_t> weights3 = {1, 1, 1};
-
+static void translate_aig_part_to_cnf(LinearizationContext& ctx, SubcircuitCnf& cnf){
   // Encoding the AIG
-  for(auto&g: gate_poly){
+  for(auto&g: ctx.gate_poly){
     if(!g->is_extension()){
       aiger_and* and1 = is_model_and(g->get_var_num());
-      int lit_id_lhs = lit_id[g];
-      int lit_id_rhs0 = aiger_sign(and1->rhs0) ? -lit_id[gate(and1->rhs0)] : lit_id[gate(and1->rhs0)];
-      int lit_id_rhs1 = aiger_sign(and1->rhs1) ? -lit_id[gate(and1->rhs1)] : lit_id[gate(and1->rhs1)];
-
-      std::vector<int> literals = {-lit_id_lhs, lit_id_rhs0};
-      firstFreshVariable = pb2cnf.encodeGeq(weights2, literals, rhs, cnf_clauses, firstFreshVariable) + 1;
-
-      std::vector<int> literals2 = {-lit_id_lhs, lit_id_rhs1};
-      firstFreshVariable = pb2cnf.encodeGeq(weights2, literals2, rhs, cnf_clauses, firstFreshVariable) + 1;
-
-      std::vector<int> literals3 = {lit_id_lhs, -lit_id_rhs0, -lit_id_rhs1};
-      firstFreshVariable = pb2cnf.encodeGeq(weights3, literals3, rhs, cnf_clauses, firstFreshVariable) + 1;
-
+      int lit_id_rhs0 = aiger_sign(and1->rhs0) ? -cnf.lit(gate(and1->rhs0)) : cnf.lit(gate(and1->rhs0));
+      int lit_id_rhs1 = aiger_sign(and1->rhs1) ? -cnf.lit(gate(and1->rhs1)) : cnf.lit(gate(and1->rhs1));
+      cnf.add_and(cnf.lit(g), lit_id_rhs0, lit_id_rhs1);
     } else {
-      int lit_id_lhs = lit_id[g];
-      int lit_id_rhs0 = lit_id[g->children_front()];
-      int lit_id_rhs1 = lit_id[g->children_back()];
-
-      std::vector<int> literals = {-lit_id_lhs, lit_id_rhs0};
-      firstFreshVariable = pb2cnf.encodeGeq(weights2, literals, rhs, cnf_clauses, firstFreshVariable) + 1;
-
-      std::vector<int> literals2 = {-lit_id_lhs, lit_id_rhs1};
-      firstFreshVariable = pb2cnf.encodeGeq(weights2, literals2, rhs, cnf_clauses, firstFreshVariable) + 1;
-
-      std::vector<int> literals3 = {lit_id_lhs, -lit_id_rhs0, -lit_id_rhs1};
-      firstFreshVariable = pb2cnf.encodeGeq(weights3, literals3, rhs, cnf_clauses, firstFreshVariable) + 1;
+      cnf.add_and(cnf.lit(g), cnf.lit(g->children_front()), cnf.lit(g->children_back()));
     }
-  }  
-  return cnf_clauses;
+  }
+  aig_clause_count += cnf.clauses().size();
 }
 /*------------------------------------------------------------------------*/
 
-static std::vector<std::vector<int>> translate_poly_to_cnf(Polynomial *p ,std::map<Gate*, int> lit_id, std::vector<std::vector<int>> cnf_clauses, bool second_call){
-  PB2CNF pb2cnf;
-    // Stores generated CNF clauses
-  int firstFreshVariable = lit_id.size() + 1;
-  
+static void translate_poly_to_cnf(Polynomial *p, const SubcircuitCnf& cnf, ClauseArena& guess, bool second_call){
   // Encoding the target polynomial
   Polynomial* p_print = p;
   if (second_call) p_print = multiply_poly_with_constant(p, minus_one);
@@ -1229,31 +1364,24 @@ static std::vector<std::vector<int>> translate_poly_to_cnf(Polynomial *p ,std::m
   for (size_t i = 0; i < p_print->len(); i++) {
     Monomial* m = p_print->get_mon(i);
     if (m->get_term()) {
-      poly_weights.push_back(mpz_get_si(m->coeff));
-      poly_ids.push_back(lit_id[gate(m->get_term()->get_var_num())]);
+      poly_weights.push_back(m->get_coeff().get_si());
+      poly_ids.push_back(cnf.lit(gate(m->get_term()->get_var_num())));
     }
   }
 
   if (!p_print->get_mon((p_print->len()) - 1)->get_term()) {  // Last term is not constant
 
-    int rhs_p = -1 * mpz_get_si(p_print->get_mon((p_print->len()) - 1)->coeff) + 1;
-    firstFreshVariable = pb2cnf.encodeGeq(poly_weights, poly_ids, rhs_p, cnf_clauses, firstFreshVariable) + 1;
+    int rhs_p = -1 * p_print->get_mon((p_print->len()) - 1)->get_coeff().get_si() + 1;
+    encode_geq(poly_weights, poly_ids, rhs_p, guess, cnf.get_first_fresh());
 
   } else {
-    firstFreshVariable = pb2cnf.encodeGeq(poly_weights, poly_ids, 1, cnf_clauses, firstFreshVariable) + 1;
+    encode_geq(poly_weights, poly_ids, 1, guess, cnf.get_first_fresh());
   }
   if (second_call) delete (p_print);
-  return cnf_clauses;
 }
 
-
 /*------------------------------------------------------------------------*/
-std::random_device seed;
-std::mt19937 generator(seed());
-std::uniform_int_distribution<uint32_t> uniform;
-std::unordered_map<Var*,int> var_to_col;
-
-static void sample_subcircuit(fmpq_mat_t mat, int row_idx) {
+static void sample_subcircuit(LinearizationContext& ctx, fmpq_mat_t mat, int row_idx) {
   int i = 0;
   uint32_t rand = 0;
 
@@ -1261,9 +1389,9 @@ static void sample_subcircuit(fmpq_mat_t mat, int row_idx) {
   fmpq_set_si(fmpq_mat_entry(mat, row_idx, fmpq_mat_ncols(mat) - 1), 1, 1);
 
   // set all inputs
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     if (i++ % 32 == 0)
-      rand = uniform(generator);
+      rand = ctx.uniform(ctx.generator);
     
     Var* v = g->get_var();
     int val = (int)(rand & 1U);
@@ -1272,11 +1400,11 @@ static void sample_subcircuit(fmpq_mat_t mat, int row_idx) {
     v->set_value(val);
     v->get_dual()->set_value(1 - val);
     
-    fmpq_set_si(fmpq_mat_entry(mat, row_idx, var_to_col[v]), val, 1);
+    fmpq_set_si(fmpq_mat_entry(mat, row_idx, ctx.var_to_col[v]), val, 1);
   }
 
   // compute outputs
-  for (auto& gate : gate_poly) {
+  for (auto& gate : ctx.gate_poly) {
     Polynomial* g = gate->get_aig_poly();
 
     int val = g->evaluate();
@@ -1285,26 +1413,26 @@ static void sample_subcircuit(fmpq_mat_t mat, int row_idx) {
     v->set_value(val);
     v->get_dual()->set_value(1 - val);
 
-    fmpq_set_si(fmpq_mat_entry(mat, row_idx, var_to_col[v]), val, 1);
+    fmpq_set_si(fmpq_mat_entry(mat, row_idx, ctx.var_to_col[v]), val, 1);
   }
 }
 /*------------------------------------------------------------------------*/
-static void sample_trivial(fmpq_mat_t mat) {
+static void sample_trivial(LinearizationContext& ctx, fmpq_mat_t mat) {
   for(int val = 0; val < 2; val++) {
 
     // constant term
     fmpq_set_si(fmpq_mat_entry(mat, val, fmpq_mat_ncols(mat) - 1), 1, 1);
     
     // set all inputs
-    for (auto& g : sc_inputs) {
+    for (auto& g : ctx.sc_inputs) {
       Var* v = g->get_var();
       v->set_value(val);
       v->get_dual()->set_value(1 - val);
-      fmpq_set_si(fmpq_mat_entry(mat, val, var_to_col[v]), val, 1);
+      fmpq_set_si(fmpq_mat_entry(mat, val, ctx.var_to_col[v]), val, 1);
     }
 
     // compute outputs
-    for (auto& gate : gate_poly) {
+    for (auto& gate : ctx.gate_poly) {
       Polynomial* g = gate->get_aig_poly();
 
       int val_g = g->evaluate();
@@ -1313,28 +1441,28 @@ static void sample_trivial(fmpq_mat_t mat) {
       v->set_value(val_g);
       v->get_dual()->set_value(1 - val_g);
 
-      fmpq_set_si(fmpq_mat_entry(mat, val, var_to_col[v]), val_g, 1);
+      fmpq_set_si(fmpq_mat_entry(mat, val, ctx.var_to_col[v]), val_g, 1);
     }
   }
 }
 
 /*------------------------------------------------------------------------*/
-static void sample_dual(fmpq_mat_t mat, int row_idx) {
+static void sample_dual(LinearizationContext& ctx, fmpq_mat_t mat, int row_idx) {
 
   // constant term
   fmpq_set_si(fmpq_mat_entry(mat, row_idx,  fmpq_mat_ncols(mat) - 1), 1, 1);
   
-  for (auto& g : sc_inputs) {
+  for (auto& g : ctx.sc_inputs) {
     Var* v = g->get_var();
     int val = v->get_value();
     v->set_value(val);
     v->get_dual()->set_value(1 - val);
     
-    fmpq_set_si(fmpq_mat_entry(mat, row_idx, var_to_col[v]), val, 1);
+    fmpq_set_si(fmpq_mat_entry(mat, row_idx, ctx.var_to_col[v]), val, 1);
   }
 
   // compute outputs
-  for (auto& gate : gate_poly) {
+  for (auto& gate : ctx.gate_poly) {
     Polynomial* g = gate->get_aig_poly();
 
     int val = g->evaluate();
@@ -1343,12 +1471,203 @@ static void sample_dual(fmpq_mat_t mat, int row_idx) {
     v->set_value(val);
     v->get_dual()->set_value(1 - val);
 
-    fmpq_set_si(fmpq_mat_entry(mat, row_idx, var_to_col[v]), val, 1);
+    fmpq_set_si(fmpq_mat_entry(mat, row_idx, ctx.var_to_col[v]), val, 1);
+  }
+}
+/*------------------------------------------------------------------------*/
+// Draws the inputs of the assignments first, ..., first + lanes - 1
+static void
+draw_simulated_inputs(LinearizationContext& ctx, SubcircuitSimulator& sim,
+                      size_t num_inputs, size_t first, size_t lanes) {
+  for (size_t j = 0; j < num_inputs; j++)
+    std::fill(sim.slot(j), sim.slot(j) + SubcircuitSimulator::block_words, 0);
+  for (size_t l = 0; l < lanes; l++) {
+    size_t s = first + l;
+    uint32_t rand = 0;
+    for (size_t j = 0; j < num_inputs; j++) {
+      bool val;
+      if (s < 2) {
+        val = s;
+      } else {
+        if (j % 32 == 0)
+          rand = ctx.uniform(ctx.generator);
+        val = rand & 1U;
+        rand >>= 1U;
+      }
+      if (val)
+        sim.slot(j)[l / 64] |= 1ull << (l % 64);
+    }
+  }
+}
+/*------------------------------------------------------------------------*/
+// Returns the column of the sample matrix of every slot of the simulator
+static std::vector<long>
+simulated_columns(LinearizationContext& ctx, const std::vector<Gate*>& inputs,
+                  const std::vector<Gate*>& gates) {
+  std::vector<long> col;
+  col.reserve(inputs.size() + gates.size());
+  for (const auto& g : inputs)
+    col.push_back(ctx.var_to_col[g->get_var()]);
+  for (const auto& g : gates)
+    col.push_back(ctx.var_to_col[g->get_var()]);
+  return col;
+}
+/*------------------------------------------------------------------------*/
+/**
+    Fills the sample matrix by bit-parallel simulation of the subcircuit.
+    As for sample_trivial(), the inputs of the first two rows are constant.
+    Every further assignment is drawn like in sample_subcircuit() and fills
+    two rows, like sample_subcircuit() and sample_dual().
+
+    @return false if the subcircuit cannot be compiled
+*/
+static bool
+sample_simulated(LinearizationContext& ctx, fmpq_mat_t mat) {
+  std::vector<Gate*> inputs(ctx.sc_inputs.begin(), ctx.sc_inputs.end());
+  std::vector<Gate*> gates(ctx.gate_poly.begin(), ctx.gate_poly.end());
+  SubcircuitSimulator sim;
+  if (!sim.compile(inputs, gates))
+    return 0;
+
+  std::vector<long> col = simulated_columns(ctx, inputs, gates);
+
+  const size_t block_bits = SubcircuitSimulator::block_bits;
+  size_t num_samples = 2 + (fmpq_mat_nrows(mat) - 2) / 2;
+  for (size_t first = 0; first < num_samples; first += block_bits) {
+    size_t lanes = std::min(block_bits, num_samples - first);
+
+    // set all inputs
+    draw_simulated_inputs(ctx, sim, inputs.size(), first, lanes);
+
+    // compute outputs
+    sim.simulate();
+
+    for (size_t l = 0; l < lanes; l++) {
+      size_t s = first + l;
+      long row = s < 2 ? s : 2 * s - 2;
+      long copies = s < 2 ? 1 : 2;
+      for (long r = row; r < row + copies; r++) {
+        // constant term
+        fmpq_set_si(fmpq_mat_entry(mat, r, fmpq_mat_ncols(mat) - 1), 1, 1);
+        // the matrix is zero initialized
+        for (size_t j = 0; j < sim.size(); j++)
+          if ((sim.slot(j)[l / 64] >> (l % 64)) & 1)
+            fmpq_set_si(fmpq_mat_entry(mat, r, col[j]), 1, 1);
+      }
+    }
+  }
+  return 1;
+}
+/*------------------------------------------------------------------------*/
+/**
+    Streams sampled assignments of the subcircuit into the kernel, until
+    its rank did not increase for max(64, ncols()) consecutive samples or
+    max_samples assignments are drawn. Assignments are drawn like in
+    sample_simulated(), but every assignment is only added once.
+*/
+static void
+sample_stream(LinearizationContext& ctx, GuessKernel& kernel, size_t max_samples) {
+  size_t window = std::max<size_t>(kernel.ncols(), 64);
+  size_t stable = 0;
+  std::vector<uint64_t> row(kernel.words());
+
+  std::vector<Gate*> inputs(ctx.sc_inputs.begin(), ctx.sc_inputs.end());
+  std::vector<Gate*> gates(ctx.gate_poly.begin(), ctx.gate_poly.end());
+  SubcircuitSimulator sim;
+  if (bit_parallel_simulation && sim.compile(inputs, gates)) {
+    std::vector<long> col = simulated_columns(ctx, inputs, gates);
+
+    const size_t block_bits = SubcircuitSimulator::block_bits;
+    for (size_t first = 0; first < max_samples && stable < window; first += block_bits) {
+      size_t lanes = std::min(block_bits, max_samples - first);
+      draw_simulated_inputs(ctx, sim, inputs.size(), first, lanes);
+      sim.simulate();
+
+      for (size_t l = 0; l < lanes && stable < window; l++) {
+        std::fill(row.begin(), row.end(), 0);
+        GuessKernel::set_bit(row.data(), kernel.ncols() - 1);
+        for (size_t j = 0; j < sim.size(); j++)
+          if ((sim.slot(j)[l / 64] >> (l % 64)) & 1)
+            GuessKernel::set_bit(row.data(), col[j]);
+        stable = kernel.push_sample(row.data()) ? 0 : stable + 1;
+      }
+    }
+    return;
+  }
+
+  for (size_t s = 0; s < max_samples && stable < window; s++) {
+    std::fill(row.begin(), row.end(), 0);
+    GuessKernel::set_bit(row.data(), kernel.ncols() - 1);
+
+    // set all inputs
+    size_t i = 0;
+    uint32_t rand = 0;
+    for (auto& g : ctx.sc_inputs) {
+      int val;
+      if (s < 2) {
+        val = s;
+      } else {
+        if (i++ % 32 == 0)
+          rand = ctx.uniform(ctx.generator);
+        val = (int)(rand & 1U);
+        rand >>= 1U;
+      }
+      Var* v = g->get_var();
+      v->set_value(val);
+      v->get_dual()->set_value(1 - val);
+      if (val)
+        GuessKernel::set_bit(row.data(), ctx.var_to_col[v]);
+    }
+
+    // compute outputs
+    for (auto& gate : ctx.gate_poly) {
+      int val = gate->get_aig_poly()->evaluate();
+      Var* v = gate->get_var();
+      v->set_value(val);
+      v->get_dual()->set_value(1 - val);
+      if (val)
+        GuessKernel::set_bit(row.data(), ctx.var_to_col[v]);
+    }
+    stable = kernel.push_sample(row.data()) ? 0 : stable + 1;
+  }
+}
+/*------------------------------------------------------------------------*/
+/**
+    Applies the result of proving p by kissat or by the truth tables of
+    exhaustive_kernel(). A correct guess becomes the normal form of its
+    leading gate, a wrong one is deleted.
+
+    @return p if it is correct, nullptr otherwise
+*/
+static Polynomial*
+apply_sat_proof(Polynomial* p, bool correct, int& sat_count) {
+  if (correct) {
+    correct_guess_count++;
+    if(proof_logging){
+      pac_add_circuit_poly(polys_file, p);
+    }
+    
+    Gate* p_lt = gate(p->get_lt()->get_var_num());
+    p_lt->set_nf(p->copy());
+    p_lt->update_gate_poly(p->copy());
+
+
+
+    if (verbose > 1) std::cout << "===== CORRECT =====" << std::endl;
+    if (verbose > 1) p->print(stdout);
+    return p;
+  } else {
+    sat_count++;
+    sat_refuted_count++;
+    if (verbose > 1) std::cout << "===== WRONG =====" << std::endl;
+    if (verbose > 1) p->print(stdout);
+    delete (p);
+    return nullptr;
   }
 }
 /*------------------------------------------------------------------------*/
 Polynomial *
-verify_guess(Polynomial* p, std::set<Polynomial*>& gb, std::vector<std::vector<int>> aig_clauses, int& eval_count, int& sat_count, std::map<Gate*, int> lit_id, std::map<int, Gate*> inverse_lit_id) {
+verify_guess(LinearizationContext& ctx, Polynomial* p, std::set<Polynomial*>& gb, const SubcircuitCnf& cnf, int& eval_count, int& sat_count) {
   evaluated_guess_count++;
   eval_count++;
   if (use_algebra_reduction) { // use ideal membership
@@ -1368,44 +1687,73 @@ verify_guess(Polynomial* p, std::set<Polynomial*>& gb, std::vector<std::vector<i
   } else {  // use KISSAT
 
   
-    auto cnf_clauses = translate_poly_to_cnf(p, lit_id, aig_clauses, 0);
-    bool run1 = call_kissat(cnf_clauses, inverse_lit_id);
+    ClauseArena guess1;
+    translate_poly_to_cnf(p, cnf, guess1, 0);
+    bool run1 = call_kissat(ctx, cnf, guess1);
 
     bool run2 = false;
     if(run1){
-      cnf_clauses = translate_poly_to_cnf(p, lit_id, aig_clauses, 1);
-      run2 = call_kissat(cnf_clauses, inverse_lit_id);
+      ClauseArena guess2;
+      translate_poly_to_cnf(p, cnf, guess2, 1);
+      run2 = call_kissat(ctx, cnf, guess2);
     }
 
-
-    if (run1 && run2) {
-      correct_guess_count++;
-      if(proof_logging){
-        pac_add_circuit_poly(polys_file, p);
-      }
-      
-      Gate* p_lt = gate(p->get_lt()->get_var_num());
-      p_lt->set_nf(p->copy());
-      p_lt->update_gate_poly(p->copy());
-
-
-
-      if (verbose > 1) std::cout << "===== CORRECT =====" << std::endl;
-      if (verbose > 1) p->print(stdout);
-      return p;
-    } else {
-      sat_count++;
-      if (verbose > 1) std::cout << "===== WRONG =====" << std::endl;
-      if (verbose > 1) p->print(stdout);
-      delete (p);
-      return nullptr;
-    }
+    return apply_sat_proof(p, run1 && run2, sat_count);
   }
 }
 /*------------------------------------------------------------------------*/
-void append_collected_assignments(fmpq_mat_t mat) {
+/**
+    Verifies the guesses by kissat like verify_guess(), but solves the two
+    directions of all guesses concurrently on a pool of worker threads.
+    The results and counter examples are merged in the order of the
+    guesses, hence they do not depend on the scheduling of the threads.
 
-  if(collected_assignments.size() == 0)
+    @return the correct guesses, nullptr for the wrong ones
+*/
+static std::vector<Polynomial*>
+verify_guesses_parallel(LinearizationContext& ctx, std::vector<Polynomial*>& guesses, const SubcircuitCnf& cnf, int& eval_count, int& sat_count, size_t workers) {
+  struct SatTask {
+    ClauseArena guess;
+    int result = 0;
+    std::vector<bool> model;
+  };
+
+  // pblib and the polynomials are not shared, hence encode sequentially
+  std::vector<SatTask> tasks(2 * guesses.size());
+  for (size_t k = 0; k < guesses.size(); k++) {
+    evaluated_guess_count++;
+    eval_count++;
+    translate_poly_to_cnf(guesses[k], cnf, tasks[2 * k].guess, 0);
+    translate_poly_to_cnf(guesses[k], cnf, tasks[2 * k + 1].guess, 1);
+  }
+
+  // the clauses of the sub-circuit are shared by all tasks
+  std::atomic<size_t> next = 0;
+  auto work = [&tasks, &next, &cnf] {
+    for (size_t t; (t = next++) < tasks.size();)
+      tasks[t].result = solve_cnf(cnf, tasks[t].guess, tasks[t].model);
+  };
+  std::vector<std::thread> pool;
+  for (size_t w = 1; w < std::min(workers, tasks.size()); w++)
+    pool.emplace_back(work);
+  work();
+  for (auto& t : pool)
+    t.join();
+
+  std::vector<Polynomial*> res;
+  for (size_t k = 0; k < guesses.size(); k++) {
+    const SatTask& run1 = tasks[2 * k];
+    const SatTask& run2 = tasks[2 * k + 1];
+    collect_kissat_result(ctx, run1.result, run1.model, cnf);
+    collect_kissat_result(ctx, run2.result, run2.model, cnf);
+    res.push_back(apply_sat_proof(guesses[k], run1.result == 20 && run2.result == 20, sat_count));
+  }
+  return res;
+}
+/*------------------------------------------------------------------------*/
+void append_collected_assignments(LinearizationContext& ctx, fmpq_mat_t mat) {
+
+  if(ctx.collected_assignments.size() == 0)
     return;
 
   // count number of nonzero rows of mat
@@ -1413,7 +1761,7 @@ void append_collected_assignments(fmpq_mat_t mat) {
   while(n < fmpq_mat_nrows(mat) && !row_is_zero(mat, n)) n++;
 
   fmpq_mat_t extended;
-  fmpq_mat_init(extended, n+collected_assignments.size(), fmpq_mat_ncols(mat));
+  fmpq_mat_init(extended, n+ctx.collected_assignments.size(), fmpq_mat_ncols(mat));
 
   // copy nonzero rows
   int i = 0;
@@ -1423,23 +1771,23 @@ void append_collected_assignments(fmpq_mat_t mat) {
 
   // append samples
   for(; i < fmpq_mat_nrows(extended); i++) {
-    auto sample = collected_assignments.front();
-    collected_assignments.pop_front();
+    auto sample = ctx.collected_assignments.front();
+    ctx.collected_assignments.pop_front();
 
     // constant term
     fmpq_set_si(fmpq_mat_entry(extended, i, fmpq_mat_ncols(mat) - 1), 1, 1);
     
-    for (auto& g : sc_inputs) {
+    for (auto& g : ctx.sc_inputs) {
       Var* v = g->get_var();
       int val = sample[g];
-      fmpq_set_si(fmpq_mat_entry(extended, i, var_to_col[v]), val, 1);
+      fmpq_set_si(fmpq_mat_entry(extended, i, ctx.var_to_col[v]), val, 1);
     }
 
     // compute outputs
-    for (auto& g : gate_poly) {
+    for (auto& g : ctx.gate_poly) {
       Var* v = g->get_var();
       int val = sample[g];
-      fmpq_set_si(fmpq_mat_entry(extended, i, var_to_col[v]), val, 1);
+      fmpq_set_si(fmpq_mat_entry(extended, i, ctx.var_to_col[v]), val, 1);
     }
   }
 
@@ -1447,18 +1795,218 @@ void append_collected_assignments(fmpq_mat_t mat) {
   fmpq_mat_clear(extended);
 }
 
+/*------------------------------------------------------------------------*/
+// Adds the counter examples found by kissat to the streamed samples
+static void
+push_collected_assignments(LinearizationContext& ctx, GuessKernel& kernel) {
+  std::vector<uint64_t> row(kernel.words());
+  while (!ctx.collected_assignments.empty()) {
+    auto& sample = ctx.collected_assignments.front();
+    std::fill(row.begin(), row.end(), 0);
+    GuessKernel::set_bit(row.data(), kernel.ncols() - 1);
+    for (auto& g : ctx.sc_inputs)
+      if (sample[g])
+        GuessKernel::set_bit(row.data(), ctx.var_to_col[g->get_var()]);
+    for (auto& g : ctx.gate_poly)
+      if (sample[g])
+        GuessKernel::set_bit(row.data(), ctx.var_to_col[g->get_var()]);
+    kernel.push_sample(row.data());
+    ctx.collected_assignments.pop_front();
+  }
+}
+
+/*------------------------------------------------------------------------*/
+
+// / blocks of assignments that refute_by_simulation() simulates
+static const size_t filter_blocks = 10;
+
+/*------------------------------------------------------------------------*/
+// Draws a word whose bits are one with probability 1/2, 1/4, 3/4, 1/8 or
+// 7/8, depending on bias
+static uint64_t
+biased_word(LinearizationContext& ctx, size_t bias) {
+  auto draw = [&ctx] {
+    return (uint64_t)ctx.uniform(ctx.generator) << 32 | ctx.uniform(ctx.generator);
+  };
+  uint64_t w = draw();
+  switch (bias % 5) {
+    case 1: return w & draw();
+    case 2: return w | draw();
+    case 3: return w & draw() & draw();
+    case 4: return w | draw() | draw();
+    default: return w;
+  }
+}
+/*------------------------------------------------------------------------*/
+/**
+    Evaluates the guesses on random assignments of the subcircuit by
+    bit-parallel simulation. Uniform assignments rarely set all inputs of
+    a wide AND, hence most blocks draw the inputs with a bias. A guess
+    that does not vanish on an assignment is wrong and deleted, and the
+    assignment is collected as counter example like the ones of kissat.
+    Only the remaining guesses and their rows are kept.
+
+    @param sim simulator compiled for inputs and gates
+*/
+static void
+refute_by_simulation(LinearizationContext& ctx, SubcircuitSimulator& sim, const std::vector<Gate*>& inputs, const std::vector<Gate*>& gates, std::vector<Polynomial*>& guesses, std::vector<int>& guess_rows, int& eval_count, int& sat_count) {
+  const size_t block_bits = SubcircuitSimulator::block_bits;
+  const size_t block_words = SubcircuitSimulator::block_words;
+
+  // guesses as slots and coefficients, skipped if they do not fit
+  struct Candidate {
+    std::vector<std::pair<size_t, int64_t>> terms;
+    int64_t constant = 0;
+    bool checked = 1;
+    bool refuted = 0;
+  };
+  std::vector<Candidate> cands(guesses.size());
+  for (size_t k = 0; k < guesses.size(); k++) {
+    Polynomial* p = guesses[k];
+    for (size_t i = 0; i < p->len() && cands[k].checked; i++) {
+      Monomial* m = p->get_mon(i);
+      long slot = m->get_term() ? sim.find_slot(m->get_term()->get_var()) : 0;
+      if (!m->get_coeff().fits_si() || slot < 0)
+        cands[k].checked = 0;
+      else if (m->get_term())
+        cands[k].terms.emplace_back(slot, m->get_coeff().get_si());
+      else
+        cands[k].constant = m->get_coeff().get_si();
+    }
+  }
+
+  for (size_t b = 0; b < filter_blocks; b++) {
+    for (size_t j = 0; j < inputs.size(); j++)
+      for (size_t w = 0; w < block_words; w++)
+        sim.slot(j)[w] = biased_word(ctx, b);
+    sim.simulate();
+
+    for (auto& cand : cands) {
+      if (!cand.checked || cand.refuted)
+        continue;
+      __int128 acc[block_bits];
+      std::fill(acc, acc + block_bits, cand.constant);
+      for (const auto& [slot, c] : cand.terms)
+        for (size_t w = 0; w < block_words; w++)
+          for (uint64_t bits = sim.slot(slot)[w]; bits; bits &= bits - 1)
+            acc[64 * w + __builtin_ctzll(bits)] += c;
+
+      size_t l = 0;
+      while (l < block_bits && !acc[l])
+        l++;
+      if (l == block_bits)
+        continue;
+
+      cand.refuted = 1;
+      std::map<Gate*, bool> assignment;
+      for (size_t j = 0; j < sim.size(); j++) {
+        Gate* g = j < inputs.size() ? inputs[j] : gates[j - inputs.size()];
+        assignment.insert({g, (sim.slot(j)[l / 64] >> (l % 64)) & 1});
+      }
+      ctx.collected_assignments.push_back(assignment);
+    }
+  }
+
+  size_t kept = 0;
+  for (size_t k = 0; k < guesses.size(); k++) {
+    if (!cands[k].refuted) {
+      guesses[kept] = guesses[k];
+      guess_rows[kept++] = guess_rows[k];
+      continue;
+    }
+    evaluated_guess_count++;
+    eval_count++;
+    sat_count++;
+    simulation_refuted_count++;
+    if (verbose > 1) std::cout << "===== WRONG (simulation) =====" << std::endl;
+    if (verbose > 1) guesses[k]->print(stdout);
+    delete (guesses[k]);
+  }
+  guesses.resize(kept);
+  guess_rows.resize(kept);
+}
+
+/*------------------------------------------------------------------------*/
+/**
+    Computes the kernel of the sample matrix of all assignments of the k
+    inputs, i.e., the linear relations that hold in the subcircuit, without
+    sampling. The truth tables of the gates are simulated block by block,
+    and only their pairwise overlaps are kept, which form the Gram matrix
+    G = M^T M of the full sample matrix M. G has the same kernel as M,
+    since G x = 0 implies |M x|^2 = x^T G x = 0. For k < 8 a block repeats
+    the assignments, which does not change the kernel either.
+
+    @param sim simulator compiled for inputs and gates
+    @param K kernel in the form of integer_kernel() of matrix.h
+*/
+static void
+exhaustive_kernel(LinearizationContext& ctx, SubcircuitSimulator& sim, const std::vector<Gate*>& inputs, const std::vector<Gate*>& gates, fmpz_mat_t K) {
+  const size_t block_words = SubcircuitSimulator::block_words;
+  const size_t block_bits = SubcircuitSimulator::block_bits;
+  static const uint64_t patterns[6] = {
+    0xAAAAAAAAAAAAAAAAull, 0xCCCCCCCCCCCCCCCCull, 0xF0F0F0F0F0F0F0F0ull,
+    0xFF00FF00FF00FF00ull, 0xFFFF0000FFFF0000ull, 0xFFFFFFFF00000000ull
+  };
+
+  std::vector<long> col = simulated_columns(ctx, inputs, gates);
+
+  // overlaps of the slots, the last entry of a row counts the ones
+  const size_t slots = sim.size();
+  std::vector<uint64_t> overlap(slots * (slots + 1), 0);
+  size_t blocks = std::max<size_t>((1ull << inputs.size()) / block_bits, 1);
+  for (size_t b = 0; b < blocks; b++) {
+    // bit s of the truth table of input j is bit j of s
+    for (size_t j = 0; j < inputs.size(); j++) {
+      for (size_t w = 0; w < block_words; w++) {
+        size_t word = b * block_words + w;
+        sim.slot(j)[w] = j < 6 ? patterns[j] : ((word >> (j - 6)) & 1 ? ~0ull : 0);
+      }
+    }
+    sim.simulate();
+
+    for (size_t i = 0; i < slots; i++) {
+      const uint64_t* x = sim.slot(i);
+      uint64_t* row = &overlap[i * (slots + 1)];
+      for (size_t w = 0; w < block_words; w++)
+        row[slots] += __builtin_popcountll(x[w]);
+      for (size_t j = i; j < slots; j++) {
+        const uint64_t* y = sim.slot(j);
+        for (size_t w = 0; w < block_words; w++)
+          row[j] += __builtin_popcountll(x[w] & y[w]);
+      }
+    }
+  }
+  exhaustive_assignment_count += blocks * block_bits;
+
+  long n = slots + 1;
+  fmpq_mat_t G;
+  fmpq_mat_init(G, n, n);
+  fmpq_set_si(fmpq_mat_entry(G, n - 1, n - 1), blocks * block_bits, 1);
+  for (size_t i = 0; i < slots; i++) {
+    const uint64_t* row = &overlap[i * (slots + 1)];
+    fmpq_set_si(fmpq_mat_entry(G, col[i], n - 1), row[slots], 1);
+    fmpq_set_si(fmpq_mat_entry(G, n - 1, col[i]), row[slots], 1);
+    for (size_t j = i; j < slots; j++) {
+      fmpq_set_si(fmpq_mat_entry(G, col[i], col[j]), row[j], 1);
+      fmpq_set_si(fmpq_mat_entry(G, col[j], col[i]), row[j], 1);
+    }
+  }
+  integer_kernel(G, K);
+  fmpq_mat_clear(G);
+}
+
 /*------------------------------------------------------------------------*/
 std::vector<Polynomial*>
-guess_linear() {
+guess_linear(LinearizationContext& ctx) {
   count_guess_call++;
 
   std::vector<Polynomial*> result;
 
   std::vector<Var*> vars;
-  for (auto& g : sc_inputs)
+  for (auto& g : ctx.sc_inputs)
     vars.push_back(g->get_var());
 
-  for (auto& g : gate_poly)
+  for (auto& g : ctx.gate_poly)
     vars.push_back(g->get_var());
 
   // sort vars in decreasing order
@@ -1466,26 +2014,50 @@ guess_linear() {
   std::sort(vars_sorted.begin(), vars_sorted.end(), [](auto& v1, auto& v2) {
     return v1->get_level() > v2->get_level();
   });
-  var_to_col.clear();
+  ctx.var_to_col.clear();
   for(int j = 0; j < vars_sorted.size(); j++)
-    var_to_col[vars_sorted[j]] = j; 
+    ctx.var_to_col[vars_sorted[j]] = j; 
 
   double pre_guess_time = process_time();
 
+  // The simulation refutes guesses before kissat, for few inputs it
+  // replaces sampling and kissat by the truth tables
+  std::vector<Gate*> sim_inputs(ctx.sc_inputs.begin(), ctx.sc_inputs.end());
+  std::vector<Gate*> sim_gates(ctx.gate_poly.begin(), ctx.gate_poly.end());
+  SubcircuitSimulator sim;
+  bool exhaustive = !use_algebra_reduction && sim_inputs.size() <= exhaustive_inputs;
+  bool compiled = (simulation_filter || exhaustive) && sim.compile(sim_inputs, sim_gates);
+  exhaustive = exhaustive && compiled;
+  bool use_filter = simulation_filter && compiled && !exhaustive;
+  if (exhaustive)
+    exhaustive_guess_call_count++;
+
   // Need one additional column for constant term
   int n = vars.size() + 1;
   int N = std::min(10 * n, 10'000) + 2;
 
+  // the streamed samples replace the rational sample matrix
+  GuessKernel stream(n);
   fmpq_mat_t mat;
-  fmpq_mat_t K;
-  fmpq_mat_init(mat, N, n);
-  fmpq_mat_init(K, 1, 1);
- 
-  sample_trivial(mat);
- 
-  for (int i = 2; i < N; i+=2) {
-    sample_subcircuit(mat, i);
-    sample_dual(mat, i+1);
+  fmpz_mat_t K;
+  fmpq_mat_init(mat, streaming_guess_kernel || exhaustive ? 0 : N, n);
+  fmpz_mat_init(K, 1, 1);
+
+  if (exhaustive) {
+    // the kernel is computed from the truth tables
+  } else if (streaming_guess_kernel) {
+    sample_stream(ctx, stream, 2 + (N - 2) / 2);
+    guess_sample_count += stream.nsamples();
+  } else {
+    if (!bit_parallel_simulation || !sample_simulated(ctx, mat)) {
+      sample_trivial(ctx, mat);
+
+      for (int i = 2; i < N; i+=2) {
+        sample_subcircuit(ctx, mat, i);
+        sample_dual(ctx, mat, i+1);
+      }
+    }
+    guess_sample_count += 2 + (N - 2) / 2;
   }
 
   std::vector<Term*> terms;
@@ -1496,7 +2068,7 @@ guess_linear() {
   terms.push_back(0);
 
   std::set<Polynomial*> gb;
-  for (const auto& gate : gate_poly) {
+  for (const auto& gate : ctx.gate_poly) {
     if(!gate->get_nf())
       gate->set_nf(gate->get_gate_constraint()->copy());
   }
@@ -1511,18 +2083,20 @@ guess_linear() {
   int eval_count = 0, sat_count = 0;
 
   // Initialize CNF Translation by generating mapping and translating aig part to cnf
-  auto mappings = var_cnf_mapping(vars_sorted);
-  auto lit_id = std::get<0>(mappings);
-  auto inverse_lit_id = std::get<1>(mappings);
-  auto aig_clauses = translate_aig_part_to_cnf(lit_id);
+  SubcircuitCnf cnf(vars_sorted);
+  if (!exhaustive)
+    translate_aig_part_to_cnf(ctx, cnf);
 
 
   while(!found_root) {
     eval_count = 0, sat_count = 0;
     iteration_count++; total_iterations_count++;
     pre_guess_time = process_time();
-    int nr_assignments = collected_assignments.size();
-    append_collected_assignments(mat);
+    int nr_assignments = ctx.collected_assignments.size();
+    if (streaming_guess_kernel)
+      push_collected_assignments(ctx, stream);
+    else
+      append_collected_assignments(ctx, mat);
     // msg("M dim = %li, %li  using %i collected assignments", fmpq_mat_nrows(mat), fmpq_mat_ncols(mat), nr_assignments);
 
     // clear result from previous iteration (if existent)
@@ -1530,20 +2104,25 @@ guess_linear() {
       delete(p);      
     result.clear();
     
-    fmpq_mat_clear(K);
-    kernel(mat, K);
+    fmpz_mat_clear(K);
+    if (exhaustive)
+      exhaustive_kernel(ctx, sim, sim_inputs, sim_gates, K);
+    else if (streaming_guess_kernel)
+      stream.kernel(K);
+    else
+      integer_kernel(mat, K);
 
-    if(fmpq_mat_nrows(K) == 0) {
+    if(fmpz_mat_nrows(K) == 0) {
       // msg("NO LINEAR POLIES IN SUBCIRCUIT");
       break;
     }
     
-    if (fmpq_is_zero(fmpq_mat_entry(K,0,0))) {
+    if (fmpz_is_zero(fmpz_mat_entry(K,0,0))) {
       // msg("NO LINEAR POLY FOR ROOT");
       break;
     }
       
-    int nr_lin_polies = fmpq_mat_nrows(K);
+    int nr_lin_polies = fmpz_mat_nrows(K);
     // msg("done guessing - building %i polies", nr_lin_polies);
     guess_time += (process_time() - pre_guess_time);
     total_guesses_count += nr_lin_polies;
@@ -1553,15 +2132,14 @@ guess_linear() {
     result.reserve(nr_lin_polies);
 
     bool all_already_linear = true;
+    std::vector<Polynomial*> guesses;
+    std::vector<int> guess_rows;
     for (int i = 0; i < nr_lin_polies; i++) {
-      if (!normalize_row(K,i))
-        continue;
-
       for (int j = 0; j < n; j++) {
-        if (fmpq_is_zero(fmpq_mat_entry(K, i, j)))
+        if (fmpz_is_zero(fmpz_mat_entry(K, i, j)))
           continue;        
         Term* t = terms[j];
-        fmpz_get_mpz(c, fmpq_mat_entry_num(K, i, j));
+        fmpz_get_mpz(c, fmpz_mat_entry(K, i, j));
         Monomial* m = new Monomial(c, t ? t->copy() : 0);
         push_mstack(m);
       }
@@ -1575,14 +2153,35 @@ guess_linear() {
       }
       
       all_already_linear = false;
-      // verify correctness
-      double pre_proof_time = process_time();
-      p = verify_guess(p, gb, aig_clauses, eval_count, sat_count, lit_id, inverse_lit_id);
-      double after_proof_time = process_time();
-      proof_time += (after_proof_time - pre_proof_time);
-      if(p) {
-        found_root = found_root or (i==0);
-        result.push_back(p);
+      guesses.push_back(p);
+      guess_rows.push_back(i);
+    }
+
+    // verify correctness, the guesses are independent
+    double pre_proof_time = process_time();
+    if (use_filter)
+      refute_by_simulation(ctx, sim, sim_inputs, sim_gates, guesses, guess_rows, eval_count, sat_count);
+    size_t workers = sat_workers();
+    if (exhaustive) {
+      // the kernel of all assignments only contains correct guesses
+      for (auto& p : guesses) {
+        evaluated_guess_count++;
+        eval_count++;
+        exhaustive_correct_count++;
+        p = apply_sat_proof(p, 1, sat_count);
+      }
+    } else if (!use_algebra_reduction && workers > 1) {
+      guesses = verify_guesses_parallel(ctx, guesses, cnf, eval_count, sat_count, workers);
+    } else {
+      for (auto& p : guesses)
+        p = verify_guess(ctx, p, gb, cnf, eval_count, sat_count);
+    }
+    double after_proof_time = process_time();
+    proof_time += (after_proof_time - pre_proof_time);
+    for (size_t k = 0; k < guesses.size(); k++) {
+      if(guesses[k]) {
+        found_root = found_root or (guess_rows[k]==0);
+        result.push_back(guesses[k]);
       } 
     }
      
@@ -1590,13 +2189,14 @@ guess_linear() {
     accuracy[iteration_count-1]+= (static_cast<double>(eval_count-sat_count)/eval_count*100);
     iteration_on_level[iteration_count-1]+=1;
     
-    if(all_already_linear) break;
+    // the kernel of the truth tables does not change
+    if(all_already_linear || exhaustive) break;
   }
   if(iteration_count > max_iterations_count) max_iterations_count = iteration_count;
   
-  collected_assignments.clear();
+  ctx.collected_assignments.clear();
   mpz_clear(c);
-  fmpq_mat_clear(K);
+  fmpz_mat_clear(K);
   fmpq_mat_clear(mat);
 
   return result;
@@ -10,23 +10,24 @@
 #define TALISMAN_SRC_SUBCIRCUIT_H_
 /*------------------------------------------------------------------------*/
 #include <gmpxx.h>
+#include <deque>
+#include <map>
+#include <random>
 #include <set>
 #include <string.h>
+#include <unordered_map>
+#include <vector>
 
-#include <pblib/pb2cnf.h>
 extern "C" {
   #include "kissat.h"  // Include Kissat header
 }
 
 #include "gate.h"
+#include "hash_val.h"
 #include "pac.h"
 #include "propagate.h"
+#include "sparse_matrix.h"
 /*------------------------------------------------------------------------*/
-extern size_t fanout_size_last_call;
-/*------------------------------------------------------------------------*/
-extern std::set<Gate*, SmallerGate> gate_poly;
-extern std::set<Gate*, LargerGate> var;
-extern std::set<Gate*, LargerGate> sc_inputs;
 
 struct Normalized_poly {
   std::vector<mpz_class> coeffs;
@@ -56,37 +57,108 @@ struct Normalized_poly {
 
 struct circuit_hash {
   size_t operator()(const std::vector<Normalized_poly>& circuit) const {
-    size_t seed = 0;
-    std::hash<std::string> h1;
-    std::hash<size_t> h2;
+    uint64_t seed = circuit.size();
     for(const auto& p : circuit) {
+      seed = hash_combine(seed, p.size());
       for(size_t i = 0; i < p.size(); i++) {
-        seed
-          ^= h1(p.coeffs[i].get_str()) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+        seed = hash_mpz(seed, p.coeffs[i].get_mpz_t());
+        seed = hash_combine(seed, p.terms[i].size());
         for(auto t : p.terms[i])
-          seed ^= h2(t) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-      } 
-      // return seed;
+          seed = hash_combine(seed, t);
+      }
     }
     return seed;
   }
 };
 
+typedef std::vector<std::pair<mpz_class, size_t>> compressed_polynomial;
+
+/** \class LinearizationContext
+    Contains the state of a single linearization, i.e., the current
+    subcircuit, its compressed form and the intermediate results of fglm
+    and guessing. The subcircuit is enlarged in place, hence the context
+    is kept for all calls of one linearization.
+*/
+struct LinearizationContext {
+  // / gates whose constraints form the subcircuit
+  std::set<Gate*, SmallerGate> gate_poly;
+
+  // / all gates occurring in the subcircuit
+  std::set<Gate*, LargerGate> var;
+
+  // / inputs of the subcircuit
+  std::set<Gate*, LargerGate> sc_inputs;
+
+  // / parent size of the gate that limited the last subcircuit
+  size_t fanout_size_last_call = 0;
+
+  // / compressed subcircuit, used as key of the cache
+  std::vector<Normalized_poly> circuit;
+
+  // / ids of the variables in the compressed subcircuit
+  std::map<Var*, size_t> var_to_id;
+
+  // / hash of the compressed subcircuit before its canonical labeling
+  size_t unlabeled_hash = 0;
+
+  // / normal forms of the gate constraints of the subcircuit
+  std::vector<Polynomial*> normal_forms;
+
+  // / compressed linear polynomials, computed or found in the cache
+  std::vector<compressed_polynomial> cache;
+
+  // / linear polynomials found in the subcircuit
+  std::vector<Polynomial*> linear_polies;
+
+  // / proof indices of the normal forms combined to each linear polynomial
+  std::vector<std::vector<int>> indices;
+
+  // / counter examples found by kissat, used as additional samples
+  std::deque<std::map<Gate*, bool>> collected_assignments;
+
+  // / column of each variable in the sample matrix
+  std::unordered_map<Var*, int> var_to_col;
+
+  // / random source for sampling
+  std::mt19937 generator;
+  std::uniform_int_distribution<uint32_t> uniform;
+
+  // / row of each term in the matrices of fglm, the terms are referenced
+  std::unordered_map<Term*, size_t> term_rows;
+
+  // / elimination of the last fglm matrix, reused for enlarged subcircuits
+  IncrementalKernel elimination;
+
+  // / term row and normal form flag of each column of the elimination
+  std::vector<std::pair<size_t, bool>> elimination_keys;
+
+  LinearizationContext()
+    : generator(std::random_device()()) {}
+
+  LinearizationContext(const LinearizationContext&) = delete;
+
+  ~LinearizationContext() {
+    for(const auto& [t, row] : term_rows)
+      if(t)
+        deallocate_term(t);
+  }
+};
+
 bool is_internal_fsa(Gate *g);
 
 bool
-get_and_compress_subcircuit(Gate* g,
+get_and_compress_subcircuit(LinearizationContext& ctx,
+                            Gate* g,
                             int depth,
                             size_t fanout_size,
                             int init, bool single_expand,
-                            std::vector<Normalized_poly>& normalized,
-                            std::map<Var*, size_t>& var_to_id);
+                            std::vector<Gate*>* new_nf = 0);
 
 std::vector<Polynomial*>
-compute_normalforms(std::vector<Polynomial*> *used_van_poly, std::vector<Polynomial*> *new_nf_poly);
+compute_normalforms(LinearizationContext& ctx, std::vector<Polynomial*> *used_van_poly, std::vector<Polynomial*> *new_nf_poly);
 
 
-std::vector<Polynomial*> guess_linear();
+std::vector<Polynomial*> guess_linear(LinearizationContext& ctx);
 
 
 #endif// TALISMAN_SRC_SUBCIRCUIT_H_
@@ -57,6 +57,29 @@ static const char *USAGE =
     "  -f <int>                         Non-negative value for fanout size, 0 turns fanout limit off (default value: 4).\n"
     "  -d <int>                         Positive value for depth (default: 2).\n"
     "\n"
+    "Cache Memory\n"
+    "--------------------------\n"
+    "  -cm <int>                        Memory budget of the circuit cache in MB, 0 turns the limit off (default: 1024).\n"
+    "\n"
+    "Proving Threads\n"
+    "--------------------------\n"
+    "  -st <int>                        Number of kissat threads proving guesses, 0 uses all cores (default: 0).\n"
+    "\n"
+    "Exhaustive Proving\n"
+    "--------------------------\n"
+    "  -ex <int>                        Sub-circuits with at most <int> inputs are proven by their truth tables\n"
+    "                                   instead of kissat, at most 30 (default: 20).\n"
+    "\n"
+    "Guess Encoding\n"
+    "--------------------------\n"
+    "  -pb <encoding>                   Encoding of guessed relations for kissat, one of auto, pblib, adder,\n"
+    "                                   bdd, sorting or card (default: auto, chosen by the coefficients).\n"
+    "\n"
+    "Cache File\n"
+    "--------------------------\n"
+    "  -cf <file> | --cache-file <file> Reuses the linearized sub-circuits of <file> and appends new ones.\n"
+    "                                   Ignored with -nch or proof logging.\n"
+    "\n"
     "Ablation\n"
     "--------------------------\n"
     "  -npp  | --no-preprocessing        Disables the preprocessing phase. (no rewriting of AIG).\n"
@@ -66,6 +89,17 @@ static const char *USAGE =
     "  -alg  | --algebraic-reduction     Use algebraic reductions instead of SAT in guess and proof\n"
     "  -gap  | --force-guessing          Forces the linearization to only use guess-and-proof\n"
     "  -fglm | --force-fglm              Forces the linearization to only use fglm\n"
+    "  -ndr  | --no-dense-reduction      Reduces the linear remainder by polynomial substitution\n"
+    "  -nnc  | --no-native-coefficients  Uses GMP integers instead of native words modulo 2^n\n"
+    "  -ntc  | --no-term-compaction      Never shrinks the term table or releases unused term memory\n"
+    "  -nsl  | --no-speculation          Selects the next sub-circuit only after the current matrix kernel\n"
+    "  -nmm  | --no-multi-modular        Computes matrix kernels by rational instead of multi-modular elimination\n"
+    "  -nsk  | --no-sparse-kernel        Eliminates the matrices of fglm densely\n"
+    "  -nik  | --no-incremental-kernel   Eliminates every matrix of fglm from scratch\n"
+    "  -ncl  | --no-canonical-labeling   Caches sub-circuits by their order of variables instead of a canonical one\n"
+    "  -nbs  | --no-bit-parallel-simulation  Samples sub-circuits one assignment at a time\n"
+    "  -nsg  | --no-streaming-guess      Samples a fixed number of assignments and guesses over the rationals\n"
+    "  -nsf  | --no-simulation-filter    Proves every guess by kissat without refuting it by simulation first\n"
     "\n"
     "\n"
     "Verbosity Levels\n"
@@ -89,6 +123,8 @@ static const char *USAGE =
 #include <cstdlib> // for std::atoi
 #include <ctime>
 
+#include "circuit_cache.h"
+#include "cnf.h"
 #include "gate.h"
 #include "parser.h"
 #include "polynomial_solver.h"
@@ -113,6 +149,9 @@ static const char *output_name2 = 0;
 // / Name of third output file. Stores the specification in '-certify'.
 static const char *output_name3 = 0;
 
+// / Name of the file caching linearized sub-circuits across runs
+static const char *cache_name = 0;
+
 
 /*------------------------------------------------------------------------*/
 // ERROR CODES:
@@ -130,11 +169,13 @@ static int err_proof_form = 13; // too many proof formats selected
     @see deallocate_terms()
     @see deallocate_mstack()
     @see clear_mpz()
+    @see CircuitCache::clear()
 */
 static void reset_all()
 {
   reset_all_signal_handlers();
   //delete_gates(); 
+  cached_circuits.clear();
   deallocate_terms();
   deallocate_mstack();
   clear_mpz();
@@ -233,6 +274,42 @@ int main(int argc, char **argv)
       i++;
     }
 
+    else if (!strcmp(argv[i], "-cm") && i + 1 < argc)
+    {
+      std::string arg_value = argv[i + 1];
+
+      if (is_number(arg_value))
+        cache_memory = std::stoul(arg_value);
+      else
+        die(123, "-cm needs to be followed by a non-negative integer");
+      i++;
+    }
+    else if (!strcmp(argv[i], "-st") && i + 1 < argc)
+    {
+      std::string arg_value = argv[i + 1];
+
+      if (is_number(arg_value))
+        sat_threads = std::stoul(arg_value);
+      else
+        die(123, "-st needs to be followed by a non-negative integer");
+      i++;
+    }
+    else if (!strcmp(argv[i], "-ex") && i + 1 < argc)
+    {
+      std::string arg_value = argv[i + 1];
+
+      if (is_number(arg_value) && std::stoul(arg_value) <= 30)
+        exhaustive_inputs = std::stoul(arg_value);
+      else
+        die(123, "-ex needs to be followed by a non-negative integer up to 30");
+      i++;
+    }
+    else if (!strcmp(argv[i], "-pb") && i + 1 < argc)
+    {
+      if (!parse_pb_encoding(argv[i + 1], pb_encoding))
+        die(123, "-pb needs to be followed by auto, pblib, adder, bdd, sorting or card");
+      i++;
+    }
     else if (!strcmp(argv[i], "-miter-spec"))
     {
       if (spec_selected)
@@ -272,6 +349,10 @@ int main(int argc, char **argv)
     {
       do_caching = 0;
     }
+    else if ((!strcmp(argv[i], "--cache-file") || !strcmp(argv[i], "-cf")) && i + 1 < argc)
+    {
+      cache_name = argv[++i];
+    }
     else if (!strcmp(argv[i], "--algebraic-reduction") || (!strcmp(argv[i], "-alg")))
     {
       use_algebra_reduction = 1;
@@ -293,6 +374,50 @@ int main(int argc, char **argv)
       force_guessing = 1;
       sc_depth = 4;
     }
+    else if (!strcmp(argv[i], "--no-dense-reduction") || (!strcmp(argv[i], "-ndr")))
+    {
+      dense_reduction = 0;
+    }
+    else if (!strcmp(argv[i], "--no-native-coefficients") || (!strcmp(argv[i], "-nnc")))
+    {
+      native_coefficients = 0;
+    }
+    else if (!strcmp(argv[i], "--no-term-compaction") || (!strcmp(argv[i], "-ntc")))
+    {
+      do_term_compaction = 0;
+    }
+    else if (!strcmp(argv[i], "--no-speculation") || (!strcmp(argv[i], "-nsl")))
+    {
+      speculative_linearization = 0;
+    }
+    else if (!strcmp(argv[i], "--no-multi-modular") || (!strcmp(argv[i], "-nmm")))
+    {
+      multi_modular = 0;
+    }
+    else if (!strcmp(argv[i], "--no-sparse-kernel") || (!strcmp(argv[i], "-nsk")))
+    {
+      sparse_kernel = 0;
+    }
+    else if (!strcmp(argv[i], "--no-incremental-kernel") || (!strcmp(argv[i], "-nik")))
+    {
+      incremental_kernel = 0;
+    }
+    else if (!strcmp(argv[i], "--no-canonical-labeling") || (!strcmp(argv[i], "-ncl")))
+    {
+      canonical_labeling = 0;
+    }
+    else if (!strcmp(argv[i], "--no-bit-parallel-simulation") || (!strcmp(argv[i], "-nbs")))
+    {
+      bit_parallel_simulation = 0;
+    }
+    else if (!strcmp(argv[i], "--no-streaming-guess") || (!strcmp(argv[i], "-nsg")))
+    {
+      streaming_guess_kernel = 0;
+    }
+    else if (!strcmp(argv[i], "--no-simulation-filter") || (!strcmp(argv[i], "-nsf")))
+    {
+      simulation_filter = 0;
+    }
     else if (!strcmp(argv[i], "--msolve") || (!strcmp(argv[i], "-m")))
     {
       msolve = 1;
@@ -363,6 +488,13 @@ int main(int argc, char **argv)
   msg("vanishing constraints: %s", do_vanishing_constraints ? "enabled" : (force_vanishing_off ? "disabled" : "partially enabled"));
   msg("local linearization: %s", do_local_lin ? "enabled" : "disabled");
   msg("caching: %s", do_caching ? "enabled" : "disabled");
+  msg("canonical labeling: %s", canonical_labeling && !proof_logging ? "enabled" : "disabled");
+  if (proof_logging || !cache_memory)
+    msg("cache memory: unlimited");
+  else
+    msg("cache memory: %lu MB", cache_memory);
+  if (cache_name)
+    msg("cache file: %s", do_caching && !proof_logging ? cache_name : "disabled");
   msg("");
   msg("fanout limitation: %s", sc_fanout ? "enabled" : "disabled");
   if(sc_fanout) msg("subcircuit fanout: %i", sc_fanout);
@@ -370,6 +502,26 @@ int main(int argc, char **argv)
   msg("");
   msg("linearization: %s", msolve ? "Groebner basis using msolve" : "Matrix-based using normal forms");
   msg("reduction: %s", use_algebra_reduction ? "Ideal membership" : "Kissat");
+  if (!use_algebra_reduction)
+  {
+    if (sat_threads)
+      msg("kissat threads: %lu", sat_threads);
+    else
+      msg("kissat threads: all cores");
+    msg("guess encoding: %s", pb_encoding_name(pb_encoding));
+    msg("exhaustive proving: up to %lu inputs", exhaustive_inputs);
+  }
+  msg("linear remainder: %s", dense_reduction && !proof_logging ? "dense" : "polynomial");
+  if (dense_reduction && !proof_logging)
+    msg("native coefficients: %s", native_coefficients ? "enabled" : "disabled");
+  msg("term compaction: %s", do_term_compaction ? "enabled" : "disabled");
+  msg("speculative sub-circuit selection: %s", speculative_linearization && !proof_logging ? "enabled" : "disabled");
+  msg("matrix elimination: %s", multi_modular ? "multi-modular" : "rational");
+  msg("sparse kernel: %s", sparse_kernel ? "enabled" : "disabled");
+  msg("incremental kernel: %s", incremental_kernel ? "enabled" : "disabled");
+  msg("bit-parallel simulation: %s", bit_parallel_simulation ? "enabled" : "disabled");
+  msg("streaming guess kernel: %s", streaming_guess_kernel ? "enabled" : "disabled");
+  msg("simulation filter: %s", simulation_filter ? "enabled" : "disabled");
   msg("");
 
   if (no_spec)
@@ -391,6 +543,9 @@ int main(int argc, char **argv)
   // Initialization Phase
   init_all_signal_handers();
   init_nonces();
+  // cache hits are applied as patterns, which need to be defined in the proof
+  if (cache_name && do_caching && !proof_logging)
+    load_circuit_cache(cache_name);
 
   parse_aig(input_name);
   bool res;
@@ -420,6 +575,7 @@ int main(int argc, char **argv)
   }
 
   res = verify(input_name, spec, output_name1, output_name2, output_name3); 
+  save_circuit_cache();
 
   // Resetting
   if (spec)
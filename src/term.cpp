@@ -8,6 +8,14 @@
 */
 /*------------------------------------------------------------------------*/
 #include "term.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+/*------------------------------------------------------------------------*/
+// ERROR CODES:
+static int err_allocate = 92;  // failed to allocate term slab
+
 /*------------------------------------------------------------------------*/
 
 Term::Term(Var* _v, Term* _r, uint64_t _hash, Term* _n)
@@ -16,7 +24,9 @@ Term::Term(Var* _v, Term* _r, uint64_t _hash, Term* _n)
   , ref(1)
   , hash(_hash)
   , next(_n)
-  , deg(_r ? (_r->degree()) + 1 : 1) {}
+  , deg(_r ? (_r->degree()) + 1 : 1)
+  , sig(var_signature(_v) | (_r ? _r->get_sig() : 0))
+  , num_dual((_v->is_dual() ? 1 : 0) + (_r ? _r->count_dual() : 0)) {}
 
 /*------------------------------------------------------------------------*/
 
@@ -83,24 +93,15 @@ fputs(tmp->get_var()->get_name(), file);
   }
 }
 /*------------------------------------------------------------------------*/
-size_t Term::count_dual() const {
-  const Term* t = this;
-  size_t i = 0;
-  while(t) {
-    if(t->get_var()->is_dual()) i++;
-    t = t->get_rest();
-  }
-  return i;
-}
-
 bool
 Term::contains( Var* v) const {
   assert(v);
+  // a suffix without the signature bit of v cannot contain v
+  const uint64_t bit = var_signature(v);
   const Term* t = this;
-  while(t) {
+  while(t && (t->get_sig() & bit)) {
     if(t->get_var() == v)
       return 1;
-    // else if (t->get_var_level() < v->get_level()) return 0;
     t = t->get_rest();
   }
   return 0;
@@ -111,6 +112,8 @@ Term::contains( Var* v) const {
 bool
 Term::contains_subterm(const Term* t) const {
   assert(t);
+  if((t->get_sig() & ~sig) || t->degree() > deg)
+    return 0;
   const Term* tmp = t;
   while(tmp) {
     if(!this->contains(tmp->get_var()))
@@ -125,7 +128,7 @@ Term::contains_subterm(const Term* t) const {
 Term::extract_first_dual_var() const {
 
   const Term* t = this;
-  while(t) {
+  while(t && t->count_dual()) {
     if(t->get_var()->is_dual())
       return t->get_var();
     t = t->get_rest();
@@ -140,6 +143,76 @@ uint64_t size_terms;
 uint64_t current_terms;
 Term** term_table;
 
+/*------------------------------------------------------------------------*/
+// Terms are allocated from aligned slabs of fixed size. Every slab starts
+// with a header counting its live terms, hence the slab of a term is found
+// by masking its address. Deallocated terms are kept in a free list and
+// reused before a new slab is allocated.
+
+struct TermSlab {
+  // / number of live terms in the slab
+  size_t live;
+};
+
+static const size_t slab_bytes = (size_t)1 << 16;
+static const size_t slab_offset =
+  (sizeof(TermSlab) + alignof(Term) - 1) / alignof(Term) * alignof(Term);
+static const size_t terms_per_slab = (slab_bytes - slab_offset) / sizeof(Term);
+
+static std::vector<TermSlab*> term_slabs;// /< all allocated slabs
+static std::vector<void*> free_terms;// /< unused slots of the slabs
+static size_t empty_term_slabs;// /< slabs without live terms
+
+/*------------------------------------------------------------------------*/
+
+static TermSlab*
+slab_of_term(const void* t) {
+  return reinterpret_cast<TermSlab*>(reinterpret_cast<uintptr_t>(t) & ~(slab_bytes - 1));
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+new_term_slab() {
+  void* mem = aligned_alloc(slab_bytes, slab_bytes);
+  if(!mem)
+    die(err_allocate, "failed to allocate term slab");
+  TermSlab* slab = static_cast<TermSlab*>(mem);
+  slab->live = 0;
+  term_slabs.push_back(slab);
+  empty_term_slabs++;
+  if(term_slabs.size() > max_term_slab_count)
+    max_term_slab_count = term_slabs.size();
+
+  // pushed in reverse, such that slots are handed out in address order
+  char* slots = static_cast<char*>(mem) + slab_offset;
+  for(size_t i = terms_per_slab; i-- > 0;)
+    free_terms.push_back(slots + i * sizeof(Term));
+}
+
+/*------------------------------------------------------------------------*/
+
+static void*
+allocate_term_slot() {
+  if(free_terms.empty())
+    new_term_slab();
+  void* res = free_terms.back();
+  free_terms.pop_back();
+  if(slab_of_term(res)->live++ == 0)
+    empty_term_slabs--;
+  return res;
+}
+
+/*------------------------------------------------------------------------*/
+
+static void
+free_term_slot(Term* t) {
+  t->~Term();
+  free_terms.push_back(t);
+  if(--slab_of_term(t)->live == 0)
+    empty_term_slabs++;
+}
+
 /*------------------------------------------------------------------------*/
 
 static uint64_t
@@ -155,8 +228,7 @@ compute_hash_term( Var* variable, const Term* rest) {
 /*------------------------------------------------------------------------*/
 
 static void
-enlarge_terms() {
-  uint64_t new_size_terms = size_terms ? 2 * size_terms : 1;
+resize_terms(uint64_t new_size_terms) {
   Term** new_term_table = new Term*[new_size_terms]();
   for(uint64_t i = 0; i < size_terms; i++) {
     for(Term *m = term_table[i], *n; m; m = n) {
@@ -173,6 +245,13 @@ enlarge_terms() {
 
 /*------------------------------------------------------------------------*/
 
+static void
+enlarge_terms() {
+  resize_terms(size_terms ? 2 * size_terms : 1);
+}
+
+/*------------------------------------------------------------------------*/
+
 Term*
 new_term(Var* variable, Term* rest) {
   if(current_terms == size_terms)
@@ -189,7 +268,7 @@ new_term(Var* variable, Term* rest) {
   if(res) {
     res->inc_ref();// here we extend that we found term once more
   } else {
-    res = new Term(variable, rest, hash, term_table[h]);
+    res = new(allocate_term_slot()) Term(variable, rest, hash, term_table[h]);
     term_table[h] = res;
     current_terms++;
   }
@@ -225,30 +304,81 @@ deallocate_term(Term* t) {
 
     assert(current_terms);
     current_terms--;
-    delete(t);
+    free_term_slot(t);
     t = rest;
   }
 }
 
 /*------------------------------------------------------------------------*/
 
+void
+compact_terms() {
+  if(!do_term_compaction)
+    return;
+
+  uint64_t new_size_terms = size_terms;
+  while(new_size_terms > 1 && 8 * current_terms < new_size_terms)
+    new_size_terms /= 2;
+  bool release_slabs = 4 * empty_term_slabs >= term_slabs.size() && empty_term_slabs;
+  if(new_size_terms == size_terms && !release_slabs)
+    return;
+
+  term_compaction_count++;
+  if(new_size_terms < size_terms)
+    resize_terms(new_size_terms);
+  if(!release_slabs)
+    return;
+
+  // drop the free slots of empty slabs, before the slabs are released
+  size_t j = 0;
+  for(size_t i = 0; i < free_terms.size(); i++) {
+    if(slab_of_term(free_terms[i])->live)
+      free_terms[j++] = free_terms[i];
+  }
+  free_terms.resize(j);
+
+  j = 0;
+  for(size_t i = 0; i < term_slabs.size(); i++) {
+    if(term_slabs[i]->live) {
+      term_slabs[j++] = term_slabs[i];
+    } else {
+      free(term_slabs[i]);
+      released_term_slab_count++;
+    }
+  }
+  term_slabs.resize(j);
+  empty_term_slabs = 0;
+}
+
+/*------------------------------------------------------------------------*/
+
 void
 deallocate_terms() {
+  term_load_factor = size_terms ? (double)current_terms / size_terms : 0;
+  term_slab_occupancy = term_slabs.empty() ? 0
+    : (double)current_terms / (term_slabs.size() * terms_per_slab);
+
   for(uint64_t i = 0; i < size_terms; i++) {
     for(Term *m = term_table[i], *n; m; m = n) {
       n = m->get_next();
       assert(current_terms);
       current_terms--;
 
-      delete(m);
+      m->~Term();
     }
   }
   delete[] term_table;
+
+  for(TermSlab* slab : term_slabs)
+    free(slab);
+  term_slabs.clear();
+  free_terms.clear();
+  empty_term_slabs = 0;
 }
 
 /*------------------------------------------------------------------------*/
 /*------------------------------------------------------------------------*/
-static std::vector< Var*> vstack;// /< used to build a term
+static thread_local std::vector< Var*> vstack;// /< used to build a term
 
 struct {
   bool operator()( Var* a,  Var* b) const {
@@ -274,7 +404,14 @@ Term*
 build_term_from_stack(bool sort) {
   if(sort)
     std::sort(vstack.begin(), vstack.end(), cmpVarLvl);
-  Term* res = 0;
+  return build_term_on_suffix(0);
+}
+
+/*------------------------------------------------------------------------*/
+
+Term*
+build_term_on_suffix(Term* suffix) {
+  Term* res = suffix ? suffix->copy() : 0;
   while(!vstack.empty()) {
     Term* t = new_term(vstack.back(), res);
     assert(t);
@@ -413,9 +550,16 @@ multiply_term_by_var(Term* t1, Var* v) {
 /*------------------------------------------------------------------------*/
 Term*
 divide_by_var(const Term* t,  Var* v) {
+  const uint64_t bit = var_signature(v);
+  while(t && t->get_var() != v && (t->get_sig() & bit)) {
+    add_to_vstack(t->get_var());
+    t = t->get_rest();
+  }
+  if(t && t->get_var() == v)// the suffix after v is shared
+    return build_term_on_suffix(t->get_rest());
+
   while(t) {
-    if(t->get_var() != v)
-      add_to_vstack(t->get_var());
+    add_to_vstack(t->get_var());
     t = t->get_rest();
   }
   Term* res = build_term_from_stack();
@@ -424,6 +568,8 @@ divide_by_var(const Term* t,  Var* v) {
 /*------------------------------------------------------------------------*/
 Term*
 divide_by_term(Term* t, const Term* t1) {
+  if(t1 && (t1->get_sig() & ~t->get_sig()))
+    return t->copy();
   Term * tmp = t;
   while(tmp && t1) {
     if(tmp->get_var() != t1->get_var())
@@ -438,11 +584,8 @@ divide_by_term(Term* t, const Term* t1) {
     return t->copy();
   }
 
-  while(tmp) {
-    add_to_vstack(tmp->get_var());
-    tmp = tmp->get_rest();
-  }
-  Term* res = build_term_from_stack();
+  // the suffix after the last variable of t1 is shared
+  Term* res = build_term_on_suffix(tmp);
   return res;
 }
 /*------------------------------------------------------------------------*/
@@ -18,9 +18,25 @@
 #include "variable.h"
 /*------------------------------------------------------------------------*/
 
+/**
+    Returns the signature bit of a variable, which is derived from the
+    hash of its name, as the level of a variable may change
+
+    @param v Var*
+
+    @return uint64_t with exactly one bit set
+*/
+inline uint64_t
+var_signature(const Var* v) {
+  return (uint64_t)1 << (((uint64_t)(uint32_t)v->get_hash() * 0x9e3779b97f4a7c15ULL) >> 58);
+}
+
 /** \class Term
     This class is used to represent terms in a polynomial.
     Terms are represented as ordered linked lists of variables.
+    Every node stores the signature of its suffix, i.e., the bitwise or of
+    the signatures of all its variables, which allows rejecting
+    containment queries with a single AND.
 */
 
 class Term {
@@ -42,6 +58,12 @@ class Term {
   // / Total degree of term
   const size_t deg;
 
+  // / signature of all variables in the term
+  const uint64_t sig;
+
+  // / number of dual variables in the term
+  const size_t num_dual;
+
   public:
   /** Constructor
 
@@ -134,6 +156,12 @@ class Term {
   */
   size_t degree() const { return deg; }
 
+  /** Getter for member sig
+
+      @return uint64_t
+  */
+  uint64_t get_sig() const { return sig; }
+
   /**
       Checks whether v is contained in Term
 
@@ -159,7 +187,12 @@ class Term {
   */
   Var* extract_first_dual_var() const;
 
-  size_t count_dual() const;
+  /**
+      Returns the number of dual variables in term
+
+      @return size_t
+  */
+  size_t count_dual() const { return num_dual; }
   /*
   Evalute the term t.
   Returns -1 if the value of t cannot be determined
@@ -225,6 +258,17 @@ clear_vstack();
 Term*
 build_term_from_stack(bool sort = 0);
 
+/**
+    Generates the term consisting of the variable stack followed by the
+    term suffix, all variables on the stack need to be larger than suffix
+
+    @param suffix Term*
+
+    @return Term*
+*/
+Term*
+build_term_on_suffix(Term* suffix);
+
 /**
     provides a vstack as parameter //TODO this should replace global vstack
 */
@@ -243,7 +287,16 @@ void
 deallocate_term(Term* t);
 
 /**
-    Deallocates the hash table "term_table"
+    Shrinks the hash table "term_table" if its load factor dropped below
+    1/8 and releases the term slabs without live terms, if at least a
+    quarter of all slabs is empty. Live terms keep their address, as they
+    are referenced by raw pointers.
+*/
+void
+compact_terms();
+
+/**
+    Deallocates the hash table "term_table" and all term slabs
 */
 void
 deallocate_terms();